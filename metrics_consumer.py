@@ -26,5 +26,8 @@ for msg in consumer:
     p = Point(m["metric"]) \
         .field("value", m["value"]) \
         .tag("symbol", m.get("symbol", "")) \
+        .tag("session", str(m.get("session", ""))) \
+        .tag("shard", str(m.get("shard", ""))) \
+        .tag("sender", str(m.get("sender", ""))) \
         .time(m["timestamp"], WritePrecision.NS)
     write_api.write(bucket="metrics", record=p)
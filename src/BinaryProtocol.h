@@ -0,0 +1,321 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include "ExecReport.h"
+#include "Order.h"
+
+// Binary order entry (TCP port 9001), version 2.
+//
+// The stream is a sequence of fixed-size little-endian messages. Each
+// starts with a MsgHeader whose `length` counts the whole message, header
+// included, and must equal the size of the struct for its `type`; anything
+// else is a framing error and the engine drops the connection. Fields are
+// naturally aligned with explicit padding, so a message is copied onto its
+// struct as is.
+//
+// Prices are integer ticks and symbols are SymbolIds, both as listed by
+// GET /symbols on the HTTP port. A symbol has to be known to the engine
+// (configured, or seen on the CSV port) before it can be traded here.
+// Orders carry no client timestamp; the engine stamps its receive time.
+//
+//   type  message       direction         bytes
+//   1     NewOrderMsg   client → engine   32
+//   2     CancelMsg     client → engine   24
+//   3     ReplaceMsg    client → engine   32
+//   4     RejectMsg     engine → client   16
+//   5     ExecReportMsg engine → client   48
+//
+// The same messages can also be sent as UDP datagrams (see UdpOrderListener).
+// A datagram is a DatagramHeader followed by one or more client messages,
+// back to back, and gets no replies.
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+              "the binary protocol is copied to and from memory as is");
+
+enum class MsgType : uint8_t
+{
+  NewOrder = 1,
+  Cancel = 2,
+  Replace = 3,
+  Reject = 4,
+  ExecReport = 5,
+};
+
+struct MsgHeader
+{
+  uint16_t length;
+  MsgType type;
+  uint8_t version; // kBinaryVersion
+};
+
+// NewOrderMsg::flags
+constexpr uint8_t kSellFlag = 1;   // else buy
+constexpr uint8_t kMarketFlag = 2; // else limit
+
+// LIMIT or MARKET order. A MARKET order's price is ignored; a limit must be
+// in 1..kMaxPrice.
+struct NewOrderMsg
+{
+  MsgHeader header;
+  uint16_t symbol;
+  uint8_t flags; // kSellFlag | kMarketFlag; other bits must be 0
+  uint8_t reserved;
+  uint64_t orderId;
+  int64_t price; // ticks
+  uint32_t accountId;
+  uint32_t quantity;
+};
+
+struct CancelMsg
+{
+  MsgHeader header;
+  uint16_t symbol;
+  uint8_t reserved[2];
+  uint64_t orderId;
+  uint32_t accountId;
+  uint8_t reserved2[4];
+};
+
+// New limit and open size for resting order `orderId`; see OrderType::REPLACE.
+struct ReplaceMsg
+{
+  MsgHeader header;
+  uint16_t symbol;
+  uint8_t reserved[2];
+  uint64_t orderId;
+  int64_t price; // ticks, 1..kMaxPrice
+  uint32_t accountId;
+  uint32_t quantity;
+};
+
+enum class BinaryReject : uint8_t
+{
+  Overloaded = 1,    // shard over its high-water mark
+  UnknownSymbol = 2, // symbol id not known to the engine
+  BadSide = 3,       // version 1 only
+  BadType = 4,       // unknown NewOrderMsg flags
+  BadFrame = 5,      // unknown type or wrong length; the connection is closed
+  UnknownOrder = 6,  // cancel or replace for an order that is not resting
+  BadPrice = 7,      // limit price outside 1..kMaxPrice
+};
+
+struct RejectMsg
+{
+  MsgHeader header;
+  BinaryReject reason;
+  uint8_t reserved[3];
+  uint64_t orderId; // 0 if the message could not be decoded
+};
+
+// What happened to an order (see ExecReport): 0 ack, 1 fill, 2 cancelled,
+// 3 replaced. Rejects come as RejectMsg.
+struct ExecReportMsg
+{
+  MsgHeader header;
+  uint8_t execType;
+  uint8_t reserved[3];
+  uint64_t orderId;
+  uint64_t tradeId;   // fill only
+  int64_t price;      // ticks: fill price, or the limit
+  uint64_t quantity;  // filled, ordered, new open size, or a MARKET order's unfilled rest
+  uint64_t timestamp;
+};
+
+// Starts every UDP datagram. `sequence` counts the sender's datagrams from 1;
+// the engine uses it to spot lost ones. Sending 1 again restarts the count.
+struct DatagramHeader
+{
+  uint32_t sender; // chosen by the client, unique among senders
+  uint8_t version; // kBinaryVersion
+  uint8_t reserved[3];
+  uint64_t sequence;
+};
+
+static_assert(sizeof(MsgHeader) == 4, "wire layout");
+static_assert(sizeof(NewOrderMsg) == 32, "wire layout");
+static_assert(sizeof(CancelMsg) == 24, "wire layout");
+static_assert(sizeof(ReplaceMsg) == 32, "wire layout");
+static_assert(sizeof(RejectMsg) == 16, "wire layout");
+static_assert(sizeof(ExecReportMsg) == 48, "wire layout");
+static_assert(sizeof(DatagramHeader) == 16, "wire layout");
+
+constexpr uint8_t kBinaryVersion = 2;
+
+// Wire size of a client → engine message type, or 0 if it is not one.
+inline size_t binaryMessageSize(MsgType type)
+{
+  switch (type)
+  {
+  case MsgType::NewOrder:
+    return sizeof(NewOrderMsg);
+  case MsgType::Cancel:
+    return sizeof(CancelMsg);
+  case MsgType::Replace:
+    return sizeof(ReplaceMsg);
+  default:
+    return 0;
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Client side: append the message for `o` (by o.type) to `out`. False,
+// with nothing appended, if its symbol, account or quantity does not fit
+// its field. The timestamp is not sent.
+// ---------------------------------------------------------------------------
+inline bool encodeOrder(const Order &o, std::string &out)
+{
+  if (o.symbol > UINT16_MAX || o.accountId > UINT32_MAX ||
+      (o.type != OrderType::CANCEL && o.quantity > UINT32_MAX))
+    return false;
+
+  auto append = [&out](const auto &msg)
+  { out.append(reinterpret_cast<const char *>(&msg), sizeof(msg)); };
+
+  switch (o.type)
+  {
+  case OrderType::LIMIT:
+  case OrderType::MARKET:
+  {
+    NewOrderMsg m{};
+    m.header = {sizeof(m), MsgType::NewOrder, kBinaryVersion};
+    m.symbol = static_cast<uint16_t>(o.symbol);
+    m.flags = static_cast<uint8_t>((o.side == Side::SELL ? kSellFlag : 0) |
+                                   (o.type == OrderType::MARKET ? kMarketFlag : 0));
+    m.orderId = o.orderId;
+    m.price = o.price;
+    m.accountId = static_cast<uint32_t>(o.accountId);
+    m.quantity = static_cast<uint32_t>(o.quantity);
+    append(m);
+    break;
+  }
+  case OrderType::CANCEL:
+  {
+    CancelMsg m{};
+    m.header = {sizeof(m), MsgType::Cancel, kBinaryVersion};
+    m.symbol = static_cast<uint16_t>(o.symbol);
+    m.orderId = o.orderId;
+    m.accountId = static_cast<uint32_t>(o.accountId);
+    append(m);
+    break;
+  }
+  case OrderType::REPLACE:
+  {
+    ReplaceMsg m{};
+    m.header = {sizeof(m), MsgType::Replace, kBinaryVersion};
+    m.symbol = static_cast<uint16_t>(o.symbol);
+    m.orderId = o.orderId;
+    m.price = o.price;
+    m.accountId = static_cast<uint32_t>(o.accountId);
+    m.quantity = static_cast<uint32_t>(o.quantity);
+    append(m);
+    break;
+  }
+  }
+  return true;
+}
+
+// Start a datagram in `out`; encodeOrder() then appends its messages.
+inline void encodeDatagramHeader(uint32_t sender, uint64_t sequence, std::string &out)
+{
+  DatagramHeader h{};
+  h.sender = sender;
+  h.version = kBinaryVersion;
+  h.sequence = sequence;
+  out.append(reinterpret_cast<const char *>(&h), sizeof(h));
+}
+
+// ---------------------------------------------------------------------------
+// Engine side
+// ---------------------------------------------------------------------------
+enum class DecodeStatus
+{
+  Ok,         // `out` holds the order
+  Incomplete, // need more bytes
+  Rejected,   // well framed but invalid; `reason` says why
+  BadFrame,   // stream is not valid protocol; stop reading it
+};
+
+// Decode the message at the front of `data`. `used` is its length whenever
+// the status is Ok or Rejected. The symbol id is not checked here, and the
+// timestamp is left 0 for the receiver to stamp.
+inline DecodeStatus decodeMessage(const char *data, size_t size, Order &out,
+                                  size_t &used, BinaryReject &reason)
+{
+  if (size < sizeof(MsgHeader))
+    return DecodeStatus::Incomplete;
+  MsgHeader header;
+  std::memcpy(&header, data, sizeof(header));
+  size_t expected = binaryMessageSize(header.type);
+  if (expected == 0 || header.length != expected || header.version != kBinaryVersion)
+  {
+    reason = BinaryReject::BadFrame;
+    return DecodeStatus::BadFrame;
+  }
+  if (size < expected)
+    return DecodeStatus::Incomplete;
+  used = expected;
+
+  switch (header.type)
+  {
+  case MsgType::NewOrder:
+  {
+    NewOrderMsg m;
+    std::memcpy(&m, data, sizeof(m));
+    out = {m.orderId, m.accountId, m.symbol, m.flags & kSellFlag ? Side::SELL : Side::BUY,
+           m.flags & kMarketFlag ? OrderType::MARKET : OrderType::LIMIT,
+           m.price, m.quantity, 0};
+    if (m.flags & ~(kSellFlag | kMarketFlag))
+      reason = BinaryReject::BadType;
+    else if (out.type == OrderType::LIMIT && (m.price <= 0 || m.price > kMaxPrice))
+      reason = BinaryReject::BadPrice;
+    else
+      return DecodeStatus::Ok;
+    return DecodeStatus::Rejected;
+  }
+  case MsgType::Cancel:
+  {
+    CancelMsg m;
+    std::memcpy(&m, data, sizeof(m));
+    out = {m.orderId, m.accountId, m.symbol, Side::BUY, OrderType::CANCEL, 0, 0, 0};
+    return DecodeStatus::Ok;
+  }
+  default:
+  {
+    ReplaceMsg m;
+    std::memcpy(&m, data, sizeof(m));
+    out = {m.orderId, m.accountId, m.symbol, Side::BUY, OrderType::REPLACE,
+           m.price, m.quantity, 0};
+    if (m.price > 0 && m.price <= kMaxPrice)
+      return DecodeStatus::Ok;
+    reason = BinaryReject::BadPrice;
+    return DecodeStatus::Rejected;
+  }
+  }
+}
+
+inline void encodeReject(uint64_t orderId, BinaryReject reason, std::string &out)
+{
+  RejectMsg m{};
+  m.header = {sizeof(m), MsgType::Reject, kBinaryVersion};
+  m.reason = reason;
+  m.orderId = orderId;
+  out.append(reinterpret_cast<const char *>(&m), sizeof(m));
+}
+
+// A Rejected report becomes a RejectMsg.
+inline void encodeExecReport(const ExecReport &r, std::string &out)
+{
+  if (r.type == ExecType::Rejected)
+    return encodeReject(r.orderId, BinaryReject::UnknownOrder, out);
+  ExecReportMsg m{};
+  m.header = {sizeof(m), MsgType::ExecReport, kBinaryVersion};
+  m.execType = static_cast<uint8_t>(r.type);
+  m.orderId = r.orderId;
+  m.tradeId = r.tradeId;
+  m.price = r.price;
+  m.quantity = r.quantity;
+  m.timestamp = r.timestamp;
+  out.append(reinterpret_cast<const char *>(&m), sizeof(m));
+}
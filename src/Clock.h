@@ -0,0 +1,47 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+// Source of event timestamps in nanoseconds. The engine reads it once per
+// incoming order and stamps every fill of that order with the same value.
+class Clock
+{
+public:
+  virtual ~Clock() = default;
+  virtual uint64_t now() = 0;
+};
+
+class SystemClock : public Clock
+{
+public:
+  static uint64_t read()
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::high_resolution_clock::now().time_since_epoch())
+        .count();
+  }
+
+  uint64_t now() override { return read(); }
+};
+
+// Deterministic time for replays and benchmarks: every read returns the
+// current value and advances it by `step`.
+class LogicalClock : public Clock
+{
+public:
+  explicit LogicalClock(uint64_t start = 0, uint64_t step = 1)
+      : next_(start), step_(step) {}
+
+  uint64_t now() override
+  {
+    uint64_t t = next_;
+    next_ += step_;
+    return t;
+  }
+
+  void set(uint64_t t) { next_ = t; }
+
+private:
+  uint64_t next_;
+  uint64_t step_;
+};
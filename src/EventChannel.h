@@ -0,0 +1,93 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <variant>
+#include "Order.h"
+#include "SpscRing.h"
+#include "Trade.h"
+#include "WaitStrategy.h"
+
+// Summary of one matched batch, for the publisher's metrics.
+struct BatchStats
+{
+  uint32_t orders;
+  uint64_t latencyNs; // time spent matching the batch
+  int64_t timestamp;  // ns since epoch at batch end
+  uint64_t idleNs;    // engine thread's cumulative idle time
+};
+
+// Everything an engine thread hands to its publisher: accepted orders (for
+// the journal and the orders topic), fills, and per-batch stats.
+using EngineEvent = std::variant<Order, Trade, BatchStats>;
+
+// What the engine does when its publisher has fallen a full ring behind.
+//   Block - wait for space: nothing is lost, matching stalls.
+//   Drop  - discard the event and count it: matching never waits, journal
+//           and Kafka get gaps. Only for deployments where they are
+//           best-effort.
+enum class OverflowPolicy { Block, Drop };
+
+// "drop" or "block"; anything else is Block.
+inline OverflowPolicy parseOverflowPolicy(const std::string &name)
+{
+  return name == "drop" ? OverflowPolicy::Drop : OverflowPolicy::Block;
+}
+
+// Engine thread → publisher thread hand-off over a preallocated SPSC ring.
+class EventChannel
+{
+public:
+  explicit EventChannel(size_t capacity = 1u << 16,
+                        OverflowPolicy policy = OverflowPolicy::Block)
+      : ring_(capacity), policy_(policy) {}
+
+  OverflowPolicy policy() const { return policy_; }
+
+  // Producer side. Returns false if the event was dropped.
+  bool push(const EngineEvent &e)
+  {
+    if (ring_.try_push(e))
+      return true;
+    if (policy_ == OverflowPolicy::Drop)
+    {
+      dropped_.store(dropped_.load(std::memory_order_relaxed) + 1,
+                     std::memory_order_relaxed);
+      return false;
+    }
+    stalls_.store(stalls_.load(std::memory_order_relaxed) + 1,
+                  std::memory_order_relaxed);
+    wait_.notify(); // the publisher may be asleep on a ring we just filled
+    for (unsigned i = 0; !ring_.try_push(e); ++i)
+    {
+      if (i < 1024)
+        cpuRelax();
+      else
+        std::this_thread::yield();
+    }
+    return true;
+  }
+
+  // Producer side: wake the publisher once a batch has been pushed.
+  void publish() { wait_.notify(); }
+
+  // Consumer side.
+  bool pop(EngineEvent &e) { return ring_.try_pop(e); }
+  void waitForEvents()
+  {
+    wait_.waitUntil([this]
+                    { return ring_.size_approx() != 0; });
+  }
+
+  size_t backlog() const { return ring_.size_approx(); }
+  uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+  uint64_t stalls() const { return stalls_.load(std::memory_order_relaxed); }
+
+private:
+  SpscRing<EngineEvent> ring_;
+  OverflowPolicy policy_;
+  WaitStrategy wait_{WaitMode::Block};
+  std::atomic<uint64_t> dropped_{0}; // written by the producer only
+  std::atomic<uint64_t> stalls_{0};  // times push() had to wait for space
+};
@@ -0,0 +1,27 @@
+#pragma once
+#include <cstdint>
+#include "Order.h"
+
+enum class ExecType : uint8_t
+{
+  Ack,       // order taken by the engine (before any fills)
+  Fill,      // one fill, on either side of a trade
+  Cancelled, // no longer live: cancelled, or a MARKET order's unfilled rest
+  Replaced,  // REPLACE applied
+  Rejected,  // CANCEL or REPLACE for an order that is not resting
+};
+
+// What happened to one of a session's orders, as routed back to it by
+// ShardedEngine::report().
+struct ExecReport
+{
+  uint64_t orderId;
+  uint64_t tradeId;   // Fill only
+  Price price;        // Fill: trade price; Ack, Replaced: limit (ticks)
+  uint64_t quantity;  // Fill: filled; Ack: ordered; Replaced: new open size;
+                      // Cancelled: a MARKET order's unfilled rest
+  uint64_t timestamp; // Fill: trade time; else the order's
+  SymbolId symbol;
+  uint32_t session;   // recipient
+  ExecType type;
+};
@@ -0,0 +1,74 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Fixed log-linear histogram for non-negative integer samples (batch sizes,
+// nanosecond latencies). Each power of two is split into 4 sub-buckets, so
+// reported percentiles are within 25% of the true value; recording is a
+// couple of bit operations and never allocates.
+class Histogram
+{
+public:
+  void record(uint64_t v)
+  {
+    ++buckets_[bucketOf(v)];
+    ++count_;
+    sum_ += v;
+    if (v > max_)
+      max_ = v;
+  }
+
+  uint64_t count() const { return count_; }
+  uint64_t max() const { return max_; }
+  double mean() const { return count_ ? double(sum_) / double(count_) : 0.0; }
+
+  // Upper bound of the bucket holding the p-th percentile (0 < p <= 1).
+  uint64_t percentile(double p) const
+  {
+    if (count_ == 0)
+      return 0;
+    uint64_t rank = static_cast<uint64_t>(p * double(count_));
+    if (rank == 0)
+      rank = 1;
+    uint64_t seen = 0;
+    for (size_t b = 0; b < kBuckets; ++b)
+    {
+      seen += buckets_[b];
+      if (seen >= rank)
+        return upperBound(b) < max_ ? upperBound(b) : max_;
+    }
+    return max_;
+  }
+
+  void reset() { *this = Histogram{}; }
+
+private:
+  static constexpr unsigned kSub = 2; // log2 of sub-buckets per octave
+  static constexpr size_t kBuckets = (64 - kSub + 1) << kSub;
+
+  // Values below 2^kSub get exact buckets; above that, bucket by the top
+  // kSub + 1 significant bits.
+  static size_t bucketOf(uint64_t v)
+  {
+    if (v < (uint64_t{1} << kSub))
+      return static_cast<size_t>(v);
+    unsigned msb = 63 - static_cast<unsigned>(__builtin_clzll(v));
+    unsigned shift = msb - kSub;
+    return (size_t(shift + 1) << kSub) + ((v >> shift) & ((1u << kSub) - 1));
+  }
+
+  static uint64_t upperBound(size_t b)
+  {
+    if (b < (size_t{1} << kSub))
+      return b;
+    unsigned shift = static_cast<unsigned>(b >> kSub) - 1;
+    uint64_t mantissa = (b & ((1u << kSub) - 1)) | (uint64_t{1} << kSub);
+    return ((mantissa + 1) << shift) - 1;
+  }
+
+  std::array<uint64_t, kBuckets> buckets_{};
+  uint64_t count_ = 0;
+  uint64_t sum_ = 0;
+  uint64_t max_ = 0;
+};
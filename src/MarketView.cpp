@@ -0,0 +1,51 @@
+#include "MarketView.h"
+#include <algorithm>
+
+std::vector<Trade> BookView::recentTrades(size_t limit) const
+{
+  size_t n = std::min<uint64_t>({limit, tradesSeen, kTrades});
+  std::vector<Trade> out;
+  out.reserve(n);
+  for (uint64_t i = tradesSeen - n; i < tradesSeen; ++i)
+    out.push_back(trades[i % kTrades]);
+  return out;
+}
+
+MarketViews::MarketViews(size_t capacity)
+    : capacity_(capacity), slots_(new std::atomic<Slot *>[capacity])
+{
+  for (size_t i = 0; i < capacity_; ++i)
+    slots_[i].store(nullptr, std::memory_order_relaxed);
+}
+
+MarketViews::~MarketViews()
+{
+  for (size_t i = 0; i < capacity_; ++i)
+    delete slots_[i].load(std::memory_order_relaxed);
+}
+
+BookView &MarketViews::stage(SymbolId symbol)
+{
+  Slot *slot = slots_[symbol].load(std::memory_order_relaxed);
+  if (!slot)
+  {
+    slot = new Slot();
+    slots_[symbol].store(slot, std::memory_order_release);
+  }
+  return slot->staged;
+}
+
+void MarketViews::publish(SymbolId symbol)
+{
+  Slot *slot = slots_[symbol].load(std::memory_order_relaxed);
+  if (slot)
+    slot->published.store(slot->staged);
+}
+
+uint64_t MarketViews::read(SymbolId symbol, BookView &out) const
+{
+  if (symbol >= capacity_)
+    return 0;
+  Slot *slot = slots_[symbol].load(std::memory_order_acquire);
+  return slot ? slot->published.load(out) : 0;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "OrderBook.h"
+#include "Seqlock.h"
+#include "Trade.h"
+
+// Top-of-book depth and recent fills for one symbol, as published by the
+// engine thread that owns it. Plain data so it can sit in a Seqlock.
+struct BookView
+{
+  static constexpr size_t kDepth = 32;  // levels per side
+  static constexpr size_t kTrades = 64; // recent fills kept
+
+  uint32_t bidCount = 0;
+  uint32_t askCount = 0;
+  uint64_t tradesSeen = 0; // fills ever appended; ring position of the next
+  BookLevel bids[kDepth]{};
+  BookLevel asks[kDepth]{};
+  Trade trades[kTrades]{};
+
+  void appendTrade(const Trade &t) { trades[tradesSeen++ % kTrades] = t; }
+  // Up to `limit` most recent fills, oldest first.
+  std::vector<Trade> recentTrades(size_t limit) const;
+};
+
+// Per-symbol BookViews readable from any thread. Each symbol has a single
+// writer (its engine thread), which edits a private staging copy and then
+// publishes it; readers copy the last published version and never block
+// the writer.
+class MarketViews
+{
+public:
+  explicit MarketViews(size_t capacity);
+  ~MarketViews();
+
+  MarketViews(const MarketViews &) = delete;
+  MarketViews &operator=(const MarketViews &) = delete;
+
+  // Writer side.
+  BookView &stage(SymbolId symbol);
+  void publish(SymbolId symbol);
+
+  // Reader side: copies the latest view into `out` and returns its version
+  // (number of publishes so far), or 0 if nothing has been published yet.
+  uint64_t read(SymbolId symbol, BookView &out) const;
+
+private:
+  struct Slot
+  {
+    BookView staged;
+    Seqlock<BookView> published;
+  };
+
+  size_t capacity_;
+  std::unique_ptr<std::atomic<Slot *>[]> slots_; // indexed by SymbolId
+};
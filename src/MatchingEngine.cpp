@@ -1,63 +1,143 @@
 #include "MatchingEngine.h"
+#include <algorithm>
+
+MatchingEngine::MatchingEngine(std::shared_ptr<SymbolDirectory> symbols,
+                               const PoolConfig &pools)
+    : symbols_(std::move(symbols)),
+      pools_(std::make_shared<BookPools>(pools)),
+      clock_(std::make_shared<SystemClock>()),
+      recent_(kRecentTrades)
+{
+}
+
+MatchingEngine::Book &MatchingEngine::bookFor(SymbolId symbol)
+{
+  if (symbol >= books_.size())
+    books_.resize(symbol + 1);
+  auto &slot = books_[symbol];
+  if (!slot)
+  {
+    // Books are not movable (they own pooled nodes): build them in place.
+    const auto &spec = symbols_->spec(symbol);
+    if (spec.book == BookType::Array)
+      slot = std::make_unique<Book>(std::in_place_type<ArrayOrderBook>,
+                                    symbol, spec.tickSize, spec.ladder, pools_);
+    else
+      slot = std::make_unique<Book>(std::in_place_type<OrderBook>,
+                                    symbol, spec.tickSize, spec.ladder, pools_);
+  }
+  return *slot;
+}
 
 std::vector<Trade> MatchingEngine::onNewOrder(const Order &order)
 {
-  auto it = books_.find(order.symbol);
-  if (it == books_.end())
+  std::vector<Trade> trades;
+  onNewOrder(order, trades);
+  return trades;
+}
+
+void MatchingEngine::touch(SymbolId symbol)
+{
+  if (symbol >= isDirty_.size())
+    isDirty_.resize(symbol + 1);
+  if (!isDirty_[symbol])
   {
-    auto res = books_.emplace(
-        order.symbol,
-        OrderBook(order.symbol));
-    it = res.first;
+    isDirty_[symbol] = 1;
+    dirty_.push_back(symbol);
   }
-  OrderBook &book = it->second;
+}
 
-  auto trades = book.addOrder(order);
+bool MatchingEngine::onNewOrder(const Order &order, std::vector<Trade> &trades)
+{
+  touch(order.symbol);
+  size_t first = trades.size();
+  uint64_t now = clock_->now();
+  bool applied = std::visit([&](auto &book)
+                            { return book.addOrder(order, trades, now); },
+                            bookFor(order.symbol));
 
-  for (auto &t : trades)
+  for (size_t i = first; i < trades.size(); ++i)
   {
-    t.tradeId = nextTradeId_++;
-    trades_.push_back(t);
+    trades[i].tradeId = nextTradeId_;
+    nextTradeId_ += tradeIdStride_;
+    recent_[recorded_++ % kRecentTrades] = trades[i];
   }
-  return trades;
+  return applied;
 }
 
-void MatchingEngine::onCancel(uint64_t orderId, const std::string &symbol)
+void MatchingEngine::onCancel(uint64_t orderId, SymbolId symbol)
 {
-  auto it = books_.find(symbol);
-  if (it != books_.end())
+  if (symbol < books_.size() && books_[symbol])
   {
-    it->second.cancelOrder(orderId);
+    touch(symbol);
+    std::visit([&](auto &book)
+               { book.cancelOrder(orderId); },
+               *books_[symbol]);
   }
 }
 
 std::vector<Trade> MatchingEngine::collectTrades()
 {
-  auto out = std::move(trades_);
-  trades_.clear();
+  // Fills older than the ring's capacity are gone; start at the oldest kept.
+  uint64_t oldest = recorded_ > kRecentTrades ? recorded_ - kRecentTrades : 0;
+  uint64_t from = std::max(collected_, oldest);
+  lost_ += from - collected_;
+  std::vector<Trade> out;
+  out.reserve(recorded_ - from);
+  for (uint64_t i = from; i < recorded_; ++i)
+    out.push_back(recent_[i % kRecentTrades]);
+  collected_ = recorded_;
   return out;
 }
 
-std::vector<OrderBook::Level>
-MatchingEngine::snapshotBook(const std::string &symbol, size_t depth)
+std::vector<BookLevel>
+MatchingEngine::snapshotBook(SymbolId symbol, size_t depth)
 {
-  auto it = books_.find(symbol);
-  if (it == books_.end())
+  if (symbol >= books_.size() || !books_[symbol])
     return {};
-  return it->second.getBids(depth);
+  return std::visit([&](const auto &book)
+                    { return book.getBids(depth); },
+                    *books_[symbol]);
 }
 
 std::vector<Trade>
-MatchingEngine::recentTrades(const std::string &symbol, size_t limit)
+MatchingEngine::recentTrades(SymbolId symbol, size_t limit)
 {
   std::vector<Trade> out;
-  for (auto it = trades_.rbegin();
-       it != trades_.rend() && out.size() < limit;
-       ++it)
+  uint64_t kept = std::min<uint64_t>(recorded_, kRecentTrades);
+  for (uint64_t i = 0; i < kept && out.size() < limit; ++i)
   {
-    if (it->symbol == symbol)
-      out.push_back(*it);
+    const Trade &t = recent_[(recorded_ - 1 - i) % kRecentTrades];
+    if (t.symbol == symbol)
+      out.push_back(t);
   }
   std::reverse(out.begin(), out.end());
   return out;
-}
\ No newline at end of file
+}
+
+void MatchingEngine::publishViews(MarketViews &views)
+{
+  uint64_t oldest = recorded_ > kRecentTrades ? recorded_ - kRecentTrades : 0;
+  uint64_t from = std::max(viewed_, oldest);
+  unviewed_ += from - viewed_;
+  for (uint64_t i = from; i < recorded_; ++i)
+  {
+    const Trade &t = recent_[i % kRecentTrades];
+    views.stage(t.symbol).appendTrade(t);
+  }
+  viewed_ = recorded_;
+
+  for (SymbolId symbol : dirty_)
+  {
+    BookView &view = views.stage(symbol);
+    std::visit([&](const auto &book)
+               {
+                 view.bidCount = static_cast<uint32_t>(book.getBids(view.bids, BookView::kDepth));
+                 view.askCount = static_cast<uint32_t>(book.getAsks(view.asks, BookView::kDepth));
+               },
+               bookFor(symbol));
+    views.publish(symbol);
+    isDirty_[symbol] = 0;
+  }
+  dirty_.clear();
+}
@@ -1,24 +1,83 @@
 #pragma once
-#include <unordered_map>
+#include <memory>
+#include <variant>
 #include <vector>
+#include "Clock.h"
+#include "MarketView.h"
 #include "OrderBook.h"
 #include "Order.h"
+#include "SymbolDirectory.h"
 #include "Trade.h"
 
 class MatchingEngine {
 public:
+  explicit MatchingEngine(std::shared_ptr<SymbolDirectory> symbols =
+                              std::make_shared<SymbolDirectory>(),
+                          const PoolConfig &pools = {});
+
   std::vector<Trade> onNewOrder(const Order& order);
-  void onCancel(uint64_t orderId, const std::string& symbol);
+  // Appends this order's fills (with trade ids assigned) to `trades`. False
+  // if a CANCEL or REPLACE found no resting order.
+  bool onNewOrder(const Order& order, std::vector<Trade>& trades);
+  void onCancel(uint64_t orderId, SymbolId symbol);
+  // Fills since the last call, oldest first. Only the last kRecentTrades
+  // are kept between calls; any older ones are counted in lostTrades().
   std::vector<Trade> collectTrades();
+  uint64_t lostTrades() const { return lost_; }
 
-  std::vector<OrderBook::Level>
-  snapshotBook(const std::string& symbol, size_t depth);
+  std::vector<BookLevel>
+  snapshotBook(SymbolId symbol, size_t depth);
 
   std::vector<Trade>
-  recentTrades(const std::string& symbol, size_t limit);
+  recentTrades(SymbolId symbol, size_t limit);
+
+  // Refresh and publish the view of every symbol touched since the last
+  // call: depth from its book, new fills from the recent-trades ring. Call
+  // from the engine thread, e.g. once per batch; fills that left the ring
+  // before a call are counted in unviewedTrades().
+  void publishViews(MarketViews& views);
+  uint64_t unviewedTrades() const { return unviewed_; }
+
+  // Fills kept for collectTrades(), recentTrades() and publishViews().
+  static constexpr size_t kRecentTrades = 4096;
+
+  // Event time source; defaults to SystemClock. Read once per order.
+  void setClock(std::shared_ptr<Clock> clock) { clock_ = std::move(clock); }
+  // Trade ids issued are first, first + stride, ... so that engines running
+  // side by side as shards never hand out the same id.
+  void setTradeIds(uint64_t first, uint64_t stride)
+  {
+    nextTradeId_ = first;
+    tradeIdStride_ = stride;
+  }
+
+  SymbolDirectory& symbols() const { return *symbols_; }
+  const BookPools& pools() const { return *pools_; }
 
 private:
-  std::unordered_map<std::string, OrderBook> books_;
-  std::vector<Trade> trades_;
+  // Book implementation is chosen per symbol by SymbolSpec::book.
+  using Book = std::variant<OrderBook, ArrayOrderBook>;
+
+  Book& bookFor(SymbolId symbol);
+  void touch(SymbolId symbol);
+
+  std::shared_ptr<SymbolDirectory> symbols_;
+  std::shared_ptr<BookPools> pools_;
+  std::shared_ptr<Clock> clock_;
+  std::vector<std::unique_ptr<Book>> books_; // indexed by SymbolId
+
+  // Ring of the most recent kRecentTrades fills, preallocated so recording
+  // never allocates.
+  std::vector<Trade> recent_;
+  uint64_t recorded_ = 0;  // fills ever recorded
+  uint64_t collected_ = 0; // fills handed out by collectTrades()
+  uint64_t lost_ = 0;      // overwritten before collectTrades() saw them
   uint64_t nextTradeId_ = 1;
+  uint64_t tradeIdStride_ = 1;
+
+  // Symbols whose view is stale, and fills not yet copied into views.
+  std::vector<SymbolId> dirty_;
+  std::vector<uint8_t> isDirty_; // indexed by SymbolId
+  uint64_t viewed_ = 0;
+  uint64_t unviewed_ = 0; // overwritten before publishViews() saw them
 };
@@ -1,17 +1,23 @@
 #pragma once
 #include <cstdint>
-#include <string>
+#include "Price.h"
+
+// Dense id assigned by SymbolDirectory.
+using SymbolId = uint32_t;
 
 enum class Side   { BUY, SELL };
-enum class OrderType { LIMIT, MARKET, CANCEL };
+enum class OrderType { LIMIT, MARKET, CANCEL, REPLACE };
 
+// REPLACE modifies the resting order `orderId`: `price` and `quantity` are
+// its new limit and new open size (side comes from the resting order).
 struct Order {
     uint64_t   orderId;
     uint64_t   accountId;
-    std::string symbol;
+    SymbolId   symbol;
     Side       side;
     OrderType  type;
-    double     price;
+    Price      price;      // ticks
     uint64_t   quantity;
     uint64_t   timestamp;  // ns since epoch
+    uint32_t   session = 0; // ShardedEngine::Session that sent it; 0 if none
 };
\ No newline at end of file
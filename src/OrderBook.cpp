@@ -1,29 +1,69 @@
 #include "OrderBook.h"
 #include <algorithm>
-#include <chrono>
+#include <limits>
 
-OrderBook::OrderBook(const std::string &symbol)
-    : symbol_(symbol)
+BookPools::BookPools(const PoolConfig &cfg)
+    : config(cfg),
+      orders(cfg.orders),
+      levels(MapLadder<std::less<>>::kNodeSize),
+      handles(nodeBlockSize<std::pair<const uint64_t, OrderNode *>>())
 {
+  levels.reserve(cfg.levels);
+  handles.reserve(cfg.orders);
 }
 
-std::vector<Trade> OrderBook::addOrder(const Order &o)
+template <class Ladders>
+BasicOrderBook<Ladders>::BasicOrderBook(SymbolId symbol, double tickSize,
+                                        const LadderConfig &ladder,
+                                        std::shared_ptr<BookPools> pools)
+    : pools_(pools ? std::move(pools) : std::make_shared<BookPools>()),
+      bids_(ladder, &pools_->levels),
+      asks_(ladder, &pools_->levels),
+      lookup_(0, std::hash<uint64_t>{}, std::equal_to<uint64_t>{},
+              typename Lookup::allocator_type(&pools_->handles)),
+      symbol_(symbol), tickSize_(tickSize)
+{
+  lookup_.reserve(pools_->config.ordersPerBook);
+}
+
+template <class Ladders>
+BasicOrderBook<Ladders>::~BasicOrderBook()
+{
+  for (auto &entry : lookup_)
+    pools_->orders.destroy(entry.second);
+}
+
+template <class Ladders>
+std::vector<Trade> BasicOrderBook<Ladders>::addOrder(const Order &o)
 {
   std::vector<Trade> trades;
+  addOrder(o, trades);
+  return trades;
+}
+
+template <class Ladders>
+bool BasicOrderBook<Ladders>::addOrder(const Order &o, std::vector<Trade> &trades)
+{
+  return addOrder(o, trades, SystemClock::read());
+}
+
+template <class Ladders>
+bool BasicOrderBook<Ladders>::addOrder(const Order &o, std::vector<Trade> &trades,
+                                       uint64_t eventTime)
+{
   uint64_t remaining = o.quantity;
 
   if (o.type == OrderType::CANCEL)
-  {
-    cancelOrder(o.orderId);
-    return trades;
-  }
+    return cancelOrder(o.orderId);
+  if (o.type == OrderType::REPLACE)
+    return replaceOrder(o, trades, eventTime);
 
-  double limitPrice = 0.0;
+  Price limitPrice = 0;
   if (o.type == OrderType::MARKET)
   {
     limitPrice = (o.side == Side::BUY
-                      ? std::numeric_limits<double>::infinity()
-                      : -std::numeric_limits<double>::infinity());
+                      ? std::numeric_limits<Price>::max()
+                      : std::numeric_limits<Price>::min());
   }
   else
   {
@@ -32,76 +72,75 @@ std::vector<Trade> OrderBook::addOrder(const Order &o)
 
   if (o.side == Side::BUY)
   {
-    auto priceCheck = [&](double lp, double lvl)
+    auto priceCheck = [&](Price lp, Price lvl)
     { return lp >= lvl; };
     while (remaining > 0 && !asks_.empty())
     {
-      auto itLevel = asks_.begin();
-      double lvlPrice = itLevel->first;
+      Price lvlPrice = asks_.bestPrice();
       if (!priceCheck(limitPrice, lvlPrice))
         break;
 
-      auto &queue = itLevel->second;
-      auto newTrades = matchAtPrice(queue, lvlPrice, remaining, o.orderId, o.side);
-      trades.insert(trades.end(), newTrades.begin(), newTrades.end());
-      for (auto &t : newTrades)
-        remaining -= t.quantity;
+      auto &queue = asks_.best();
+      remaining -= matchAtPrice(queue, lvlPrice, remaining, o.orderId, o.side,
+                                o.session, eventTime, trades);
       if (queue.empty())
-        asks_.erase(itLevel);
+        asks_.popBest();
     }
     if (o.type == OrderType::LIMIT && remaining > 0)
     {
-      Order rest = o;
-      rest.quantity = remaining;
-      bids_[o.price].push_back(rest);
-      lookup_[o.orderId] = {true, o.price};
+      bids_.push(o.price, rest(o, remaining));
     }
   }
   else
   {
-    auto priceCheck = [&](double lp, double lvl)
+    auto priceCheck = [&](Price lp, Price lvl)
     { return lp <= lvl; };
     while (remaining > 0 && !bids_.empty())
     {
-      auto itLevel = bids_.begin();
-      double lvlPrice = itLevel->first;
+      Price lvlPrice = bids_.bestPrice();
       if (!priceCheck(limitPrice, lvlPrice))
         break;
 
-      auto &queue = itLevel->second;
-      auto newTrades = matchAtPrice(queue, lvlPrice, remaining, o.orderId, o.side);
-      trades.insert(trades.end(), newTrades.begin(), newTrades.end());
-      for (auto &t : newTrades)
-        remaining -= t.quantity;
+      auto &queue = bids_.best();
+      remaining -= matchAtPrice(queue, lvlPrice, remaining, o.orderId, o.side,
+                                o.session, eventTime, trades);
       if (queue.empty())
-        bids_.erase(itLevel);
+        bids_.popBest();
     }
     if (o.type == OrderType::LIMIT && remaining > 0)
     {
-      Order rest = o;
-      rest.quantity = remaining;
-      asks_[o.price].push_back(rest);
-      lookup_[o.orderId] = {false, o.price};
+      asks_.push(o.price, rest(o, remaining));
     }
   }
+  return true;
+}
 
-  return trades;
+template <class Ladders>
+OrderNode *BasicOrderBook<Ladders>::rest(const Order &o, uint64_t remaining)
+{
+  // A reused orderId replaces whatever is still resting under it.
+  if (lookup_.count(o.orderId))
+    cancelOrder(o.orderId);
+
+  OrderNode *node = pools_->orders.create(o.orderId, o.accountId, o.side,
+                                          o.session, o.price, remaining, o.timestamp);
+  lookup_.emplace(o.orderId, node);
+  return node;
 }
 
-void OrderBook::cancelOrder(uint64_t orderId)
+template <class Ladders>
+bool BasicOrderBook<Ladders>::cancelOrder(uint64_t orderId)
 {
   auto it = lookup_.find(orderId);
   if (it == lookup_.end())
-    return;
+    return false;
 
-  bool isBid = it->second.isBid;
-  double price = it->second.price;
-  auto &queue = (isBid ? bids_[price] : asks_[price]);
+  OrderNode *node = it->second;
+  bool isBid = node->side == Side::BUY;
+  Price price = node->price;
+  auto &queue = *(isBid ? bids_.find(price) : asks_.find(price));
 
-  queue.erase(std::remove_if(queue.begin(), queue.end(),
-                             [&](const Order &o)
-                             { return o.orderId == orderId; }),
-              queue.end());
+  queue.erase(node);
 
   if (queue.empty())
   {
@@ -112,92 +151,169 @@ void OrderBook::cancelOrder(uint64_t orderId)
   }
 
   lookup_.erase(it);
+  pools_->orders.destroy(node);
+  return true;
+}
+
+template <class Ladders>
+bool BasicOrderBook<Ladders>::replaceOrder(const Order &o, std::vector<Trade> &trades,
+                                           uint64_t eventTime)
+{
+  auto it = lookup_.find(o.orderId);
+  if (it == lookup_.end())
+    return false;
+
+  OrderNode *node = it->second;
+  if (o.quantity == 0)
+  {
+    cancelOrder(o.orderId);
+    return true;
+  }
+
+  if (o.price == node->price && o.quantity <= node->quantity)
+  {
+    auto &queue = *(node->side == Side::BUY ? bids_.find(node->price)
+                                            : asks_.find(node->price));
+    queue.reduce(node, node->quantity - o.quantity);
+    return true;
+  }
+
+  Order moved{o.orderId, node->accountId, symbol_, node->side,
+              OrderType::LIMIT, o.price, o.quantity, o.timestamp, node->session};
+  cancelOrder(o.orderId);
+  addOrder(moved, trades, eventTime);
+  return true;
 }
 
-double OrderBook::bestBid() const
+template <class Ladders>
+Price BasicOrderBook<Ladders>::bestBid() const
 {
-  return bids_.empty() ? 0.0 : bids_.begin()->first;
+  return bids_.empty() ? 0 : bids_.bestPrice();
 }
 
-double OrderBook::bestAsk() const
+template <class Ladders>
+Price BasicOrderBook<Ladders>::bestAsk() const
 {
-  return asks_.empty() ? 0.0 : asks_.begin()->first;
+  return asks_.empty() ? 0 : asks_.bestPrice();
 }
 
-std::vector<Trade> OrderBook::matchAtPrice(std::deque<Order> &sideQueue,
-                                           double price,
-                                           uint64_t incomingQty,
-                                           uint64_t incomingOrderId,
-                                           Side incomingSide)
+template <class Ladders>
+uint64_t BasicOrderBook<Ladders>::matchAtPrice(Queue &sideQueue,
+                                               Price price,
+                                               uint64_t incomingQty,
+                                               uint64_t incomingOrderId,
+                                               Side incomingSide,
+                                               uint32_t incomingSession,
+                                               uint64_t eventTime,
+                                               std::vector<Trade> &trades)
 {
-  std::vector<Trade> trades;
   uint64_t remaining = incomingQty;
 
   while (remaining > 0 && !sideQueue.empty())
   {
-    Order resting = sideQueue.front();
+    OrderNode &resting = sideQueue.front();
     uint64_t tradeQty = std::min(remaining, resting.quantity);
 
-    Trade t;
+    // Build the fill in place at the end of the caller's buffer.
+    Trade &t = trades.emplace_back();
     t.tradeId = 0;
     if (incomingSide == Side::BUY)
     {
       t.buyOrderId = incomingOrderId;
       t.sellOrderId = resting.orderId;
+      t.buySession = incomingSession;
+      t.sellSession = resting.session;
     }
     else
     {
       t.buyOrderId = resting.orderId;
       t.sellOrderId = incomingOrderId;
+      t.buySession = resting.session;
+      t.sellSession = incomingSession;
     }
     t.symbol = symbol_;
     t.price = price;
     t.quantity = tradeQty;
-    t.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
-                      std::chrono::high_resolution_clock::now().time_since_epoch())
-                      .count();
-
-    trades.push_back(t);
+    t.timestamp = eventTime;
 
     if (resting.quantity > tradeQty)
     {
-      sideQueue.front().quantity -= tradeQty;
+      sideQueue.reduce(&resting, tradeQty);
       remaining = 0;
     }
     else
     {
       sideQueue.pop_front();
+      lookup_.erase(resting.orderId);
+      pools_->orders.destroy(&resting);
       remaining -= tradeQty;
     }
   }
 
-  return trades;
+  return incomingQty - remaining;
 }
 
-std::vector<OrderBook::Level> OrderBook::getBids(size_t depth) const
+template <class Ladders>
+std::vector<BookLevel>
+BasicOrderBook<Ladders>::getBids(size_t depth) const
 {
-  std::vector<Level> levels;
-  levels.reserve(depth);
-  for (auto it = bids_.begin(); it != bids_.end() && levels.size() < depth; ++it)
-  {
-    uint64_t totalQty = 0;
-    for (auto &o : it->second)
-      totalQty += o.quantity;
-    levels.push_back({it->first, totalQty});
-  }
+  std::vector<Level> levels(depth);
+  levels.resize(getBids(levels.data(), depth));
   return levels;
 }
 
-std::vector<OrderBook::Level> OrderBook::getAsks(size_t depth) const
+template <class Ladders>
+std::vector<BookLevel>
+BasicOrderBook<Ladders>::getAsks(size_t depth) const
 {
-  std::vector<Level> levels;
-  levels.reserve(depth);
-  for (auto it = asks_.begin(); it != asks_.end() && levels.size() < depth; ++it)
-  {
-    uint64_t totalQty = 0;
-    for (auto &o : it->second)
-      totalQty += o.quantity;
-    levels.push_back({it->first, totalQty});
-  }
+  std::vector<Level> levels(depth);
+  levels.resize(getAsks(levels.data(), depth));
   return levels;
 }
+
+template <class Ladders>
+size_t BasicOrderBook<Ladders>::getBids(Level *out, size_t depth) const
+{
+  size_t n = 0;
+  bids_.forEach(depth, [&](Price price, const Queue &queue)
+                {
+                  out[n++] = {price, queue.quantity(), queue.count()};
+                  return true;
+                });
+  return n;
+}
+
+template <class Ladders>
+size_t BasicOrderBook<Ladders>::getAsks(Level *out, size_t depth) const
+{
+  size_t n = 0;
+  asks_.forEach(depth, [&](Price price, const Queue &queue)
+                {
+                  out[n++] = {price, queue.quantity(), queue.count()};
+                  return true;
+                });
+  return n;
+}
+
+template <class Ladders>
+uint64_t BasicOrderBook<Ladders>::fillableQuantity(Side side, Price limit,
+                                                   uint64_t upTo) const
+{
+  uint64_t available = 0;
+  auto visit = [&](Price price, const Queue &queue)
+  {
+    bool crosses = (side == Side::BUY ? limit >= price : limit <= price);
+    if (!crosses)
+      return false;
+    available += queue.quantity();
+    return available < upTo;
+  };
+  if (side == Side::BUY)
+    asks_.forEach(std::numeric_limits<size_t>::max(), visit);
+  else
+    bids_.forEach(std::numeric_limits<size_t>::max(), visit);
+  return std::min(available, upTo);
+}
+
+template class BasicOrderBook<MapLadders>;
+template class BasicOrderBook<ArrayLadders>;
@@ -1,49 +1,125 @@
 #pragma once
-#include <map>
-#include <deque>
+#include <functional>
+#include <memory>
 #include <unordered_map>
 #include <vector>
+#include "Clock.h"
 #include "Order.h"
+#include "Pool.h"
+#include "PriceLadder.h"
 #include "Trade.h"
 
-class OrderBook
+// Aggregated quantity at one price, as returned by book snapshots.
+struct BookLevel
+{
+  Price price;
+  uint64_t quantity;
+  uint32_t orders;
+};
+
+// Capacity reserved up front so the steady-state matching path never
+// allocates: resting orders, map price levels, and lookup_ entries.
+struct PoolConfig
+{
+  size_t orders = 1u << 16;       // order nodes / lookup entries per pool
+  size_t levels = 1u << 12;       // std::map price levels per pool
+  size_t ordersPerBook = 1u << 12; // lookup_ buckets reserved by each book
+};
+
+// Allocation pools shared by the books of one engine thread.
+struct BookPools
+{
+  explicit BookPools(const PoolConfig &cfg = {});
+
+  PoolConfig config;
+  ObjectPool<OrderNode> orders;
+  SlabPool levels;  // MapLadder nodes
+  SlabPool handles; // lookup_ nodes
+};
+
+template <class Ladders>
+class BasicOrderBook
 {
 public:
-  explicit OrderBook(const std::string &symbol);
+  explicit BasicOrderBook(SymbolId symbol, double tickSize = 0.01,
+                          const LadderConfig &ladder = {},
+                          std::shared_ptr<BookPools> pools = nullptr);
+  ~BasicOrderBook();
+
+  BasicOrderBook(const BasicOrderBook &) = delete;
+  BasicOrderBook &operator=(const BasicOrderBook &) = delete;
 
   std::vector<Trade> addOrder(const Order &o);
+  // Appends fills to `trades` without clearing it. Reusing one buffer keeps
+  // matching allocation-free once its capacity has warmed up. Every fill is
+  // stamped with `eventTime`; the overloads without it read the clock once.
+  // False if a CANCEL or REPLACE found no resting order.
+  bool addOrder(const Order &o, std::vector<Trade> &trades);
+  bool addOrder(const Order &o, std::vector<Trade> &trades, uint64_t eventTime);
 
-  void cancelOrder(uint64_t orderId);
+  // False if `orderId` is not resting.
+  bool cancelOrder(uint64_t orderId);
 
-  double bestBid() const;
-  double bestAsk() const;
+  // Cancel/replace in one step. A size reduction at an unchanged price is
+  // applied in place and keeps queue priority; a price change or size
+  // increase moves the order to the back of its new level, matching first
+  // if it now crosses. Quantity 0 cancels. Returns false if not resting.
+  bool replaceOrder(const Order &o, std::vector<Trade> &trades, uint64_t eventTime);
 
-  struct Level
-  {
-    double price;
-    uint64_t quantity;
-  };
+  Price bestBid() const;
+  Price bestAsk() const;
+  SymbolId symbol() const { return symbol_; }
+  double tickSize() const { return tickSize_; }
+
+  using Level = BookLevel;
   std::vector<Level> getBids(size_t depth) const; // return up to `depth` best bids (highest price first)
   std::vector<Level> getAsks(size_t depth) const; // return up to `depth` best asks (lowest price first)
+  // Allocation-free variants: fill `out[0..depth)` and return the count.
+  size_t getBids(Level *out, size_t depth) const;
+  size_t getAsks(Level *out, size_t depth) const;
+
+  // Quantity an aggressor on `side` could fill at or through `limit`, capped
+  // at `upTo`. Walks only the levels it needs, so FOK checks stay cheap.
+  uint64_t fillableQuantity(Side side, Price limit, uint64_t upTo) const;
 
 private:
+  using BidLadder = typename Ladders::template Side<std::greater<>>;
+  using AskLadder = typename Ladders::template Side<std::less<>>;
+  using Queue = typename BidLadder::Queue;
+
+  using Lookup = std::unordered_map<
+      uint64_t, OrderNode *, std::hash<uint64_t>, std::equal_to<uint64_t>,
+      PoolAllocator<std::pair<const uint64_t, OrderNode *>>>;
+
+  std::shared_ptr<BookPools> pools_;
+
   // price → queue of orders
-  std::map<double, std::deque<Order>, std::greater<>> bids_;
-  std::map<double, std::deque<Order>, std::less<>> asks_;
-
-  // quick lookup: orderId → (side, price)
-  struct Loc
-  {
-    bool isBid;
-    double price;
-  };
-  std::unordered_map<uint64_t, Loc> lookup_;
-
-  std::string symbol_;
-
-  std::vector<Trade> matchAtPrice(std::deque<Order> &sideQueue,
-                                  double price,
-                                  uint64_t incomingQty,
-                                  uint64_t incomingOrderId,
-                                  Side incomingSide);
+  BidLadder bids_;
+  AskLadder asks_;
+
+  // quick lookup: orderId → resting node (allocated from pools_->orders)
+  Lookup lookup_;
+
+  SymbolId symbol_;
+  double tickSize_;
+
+  OrderNode *rest(const Order &o, uint64_t remaining);
+
+  // Fills against one level, appending to `trades`; returns quantity filled.
+  uint64_t matchAtPrice(Queue &sideQueue,
+                        Price price,
+                        uint64_t incomingQty,
+                        uint64_t incomingOrderId,
+                        Side incomingSide,
+                        uint32_t incomingSession,
+                        uint64_t eventTime,
+                        std::vector<Trade> &trades);
 };
+
+// std::map levels: cheap for sparse or wide-ranging books.
+using OrderBook = BasicOrderBook<MapLadders>;
+// Contiguous tick-indexed levels: fastest for liquid, narrow-range symbols.
+using ArrayOrderBook = BasicOrderBook<ArrayLadders>;
+
+extern template class BasicOrderBook<MapLadders>;
+extern template class BasicOrderBook<ArrayLadders>;
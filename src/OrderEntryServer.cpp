@@ -0,0 +1,429 @@
+#include "OrderEntryServer.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include "BinaryProtocol.h"
+#include "Clock.h"
+#include "OrderParser.h"
+
+namespace asio = boost::asio;
+using tcp = asio::ip::tcp;
+
+namespace
+{
+  constexpr size_t kReadChunk = 4096;
+  constexpr size_t kMaxBuffered = 64 * 1024; // longest partial line kept
+  constexpr auto kRetryDelay = std::chrono::microseconds(50);
+
+  template <class T>
+  void appendNumber(std::string &out, T value)
+  {
+    char buf[24];
+    auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, end);
+  }
+
+  // Decimal text for `ticks`, exact whenever some power of ten up to 10^9 is
+  // a whole number of ticks (15001 ticks of 0.01 → "150.01").
+  void appendPrice(std::string &out, Price ticks, double tickSize)
+  {
+    int64_t unit = ticksPerUnit(tickSize);
+    uint64_t scale = 1;
+    int digits = 0;
+    while (unit > 0 && scale % static_cast<uint64_t>(unit) != 0 && digits < 9)
+    {
+      scale *= 10;
+      ++digits;
+    }
+    if (unit <= 0 || scale % static_cast<uint64_t>(unit) != 0)
+    {
+      char buf[32];
+      int n = std::snprintf(buf, sizeof(buf), "%.10g", fromTicks(ticks, tickSize));
+      out.append(buf, static_cast<size_t>(n));
+      return;
+    }
+
+    uint64_t magnitude = ticks < 0 ? 0 - static_cast<uint64_t>(ticks) : static_cast<uint64_t>(ticks);
+    if (ticks < 0)
+      out += '-';
+    appendNumber(out, magnitude / static_cast<uint64_t>(unit));
+    if (digits == 0)
+      return;
+    uint64_t frac = magnitude % static_cast<uint64_t>(unit) * (scale / static_cast<uint64_t>(unit));
+    char buf[9];
+    for (int i = digits - 1; i >= 0; --i, frac /= 10)
+      buf[i] = static_cast<char>('0' + frac % 10);
+    out += '.';
+    out.append(buf, static_cast<size_t>(digits));
+  }
+}
+
+// One client. Every handler runs on the socket's strand, so the connection's
+// state (and its session) is only ever touched by one thread at a time.
+class OrderEntryServer::Connection : public std::enable_shared_from_this<Connection>
+{
+public:
+  Connection(OrderEntryServer &server, tcp::socket socket, WireFormat format, bool reports,
+             std::unique_ptr<ShardedEngine::Session> session)
+      : server_(server),
+        socket_(std::move(socket)),
+        format_(format),
+        reports_(reports),
+        retry_(socket_.get_executor()),
+        buf_(kMaxBuffered),
+        parser_(server.engines_.symbols()),
+        session_(std::move(session))
+  {
+    server_.connections_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  ~Connection() { server_.connections_.fetch_sub(1, std::memory_order_relaxed); }
+
+  void start()
+  {
+    // Reports are drained on the strand; the shard thread only posts.
+    if (reports_)
+      session_->onReports([weak = weak_from_this(), executor = socket_.get_executor()]
+                          {
+                            if (auto self = weak.lock())
+                              asio::post(executor, [self]
+                                         { self->deliver(); });
+                          });
+    asio::post(socket_.get_executor(), [self = shared_from_this()]
+               { self->read(); });
+  }
+
+private:
+  void read()
+  {
+    if (buf_.size() + kReadChunk > buf_.max_size())
+    {
+      std::cerr << "Dropping order-entry client: line too long\n";
+      return close();
+    }
+    socket_.async_read_some(buf_.prepare(kReadChunk),
+                            [this, self = shared_from_this()](boost::system::error_code ec, size_t n)
+                            {
+                              if (ec)
+                                return close();
+                              buf_.commit(n);
+                              process();
+                            });
+  }
+
+  // Submit every complete message in the buffer, then read more. Stops
+  // early, without reading, while the session is full.
+  void process()
+  {
+    if (pending_ && !submit(order_))
+      return retryLater();
+    pending_ = false;
+
+    auto data = buf_.data();
+    std::string_view bytes(static_cast<const char *>(data.data()), data.size());
+    buf_.consume(format_ == WireFormat::Binary ? processBinary(bytes) : processCsv(bytes));
+    if (pending_)
+      return retryLater();
+    if (!closing_)
+      read();
+  }
+
+  // Submit `o`, or keep it for retryLater() if the session is full. Nothing
+  // more is submitted once the client has been dropped.
+  bool offer(const Order &o)
+  {
+    if (!socket_.is_open())
+      return false;
+    if (submit(o))
+      return true;
+    order_ = o;
+    pending_ = true;
+    return false;
+  }
+
+  size_t processCsv(std::string_view text)
+  {
+    return parser_.parseLines(
+        text, [this](const Order &o)
+        { return offer(o); },
+        [this](ParseError error, const Order &o)
+        { reply("REJECT," + std::to_string(o.orderId) + ',' + parseErrorName(error) + '\n'); });
+  }
+
+  size_t processBinary(std::string_view bytes)
+  {
+    const SymbolDirectory &symbols = server_.engines_.symbols();
+    uint64_t received = SystemClock::read(); // the wire carries no timestamp
+    size_t used = 0;
+    for (;;)
+    {
+      Order o;
+      size_t n = 0;
+      BinaryReject reason{};
+      DecodeStatus status = decodeMessage(bytes.data() + used, bytes.size() - used, o, n, reason);
+      o.timestamp = received;
+      if (status == DecodeStatus::Incomplete)
+        return used;
+      if (status == DecodeStatus::BadFrame)
+      {
+        // Framing is lost: say so, and hang up once the reply is out.
+        std::string msg;
+        encodeReject(0, reason, msg);
+        reply(msg);
+        closing_ = true;
+        return bytes.size();
+      }
+      used += n;
+      if (status == DecodeStatus::Ok && o.symbol >= symbols.size())
+      {
+        status = DecodeStatus::Rejected;
+        reason = BinaryReject::UnknownSymbol;
+      }
+      if (status == DecodeStatus::Rejected)
+      {
+        std::string msg;
+        encodeReject(o.orderId, reason, msg);
+        reply(msg);
+      }
+      else if (!offer(o))
+      {
+        return used;
+      }
+    }
+  }
+
+  // False if the session would have to wait for room.
+  bool submit(const Order &o)
+  {
+    RejectReason reason;
+    if (!session_->trySubmit(o, reason))
+      return false;
+    if (reason == RejectReason::None)
+      return true;
+    if (format_ == WireFormat::Binary)
+    {
+      std::string msg;
+      encodeReject(o.orderId, BinaryReject::Overloaded, msg);
+      reply(msg);
+    }
+    else
+    {
+      reply("REJECT," + std::to_string(o.orderId) + ',' + rejectReasonName(reason) + '\n');
+    }
+    return true;
+  }
+
+  void retryLater()
+  {
+    retry_.expires_after(kRetryDelay);
+    retry_.async_wait([this, self = shared_from_this()](boost::system::error_code ec)
+                      {
+                        if (!ec && socket_.is_open())
+                          process();
+                      });
+  }
+
+  // Everything the shards reported since the last wakeup goes into the
+  // outbox, to leave in one write. A client that lets the outbox grow past
+  // maxUnsent, or its report rings fill, is not reading and is disconnected.
+  void deliver()
+  {
+    if (!socket_.is_open())
+      return;
+    const SymbolDirectory &symbols = server_.engines_.symbols();
+    session_->pollReports([&](const ExecReport &r)
+                          {
+                            if (format_ == WireFormat::Binary)
+                              encodeExecReport(r, outbox_);
+                            else
+                              appendCsvReport(r, symbols.tickSize(r.symbol));
+                          });
+    if (tooFarBehind())
+      return;
+    if (session_->reportsDropped() > 0 && !closing_)
+    {
+      std::cerr << "Dropping order-entry client: not reading its reports\n";
+      closing_ = true;
+      retry_.cancel();
+    }
+    if (writing_.empty() && !outbox_.empty())
+      flush();
+    else if (writing_.empty() && closing_)
+      close();
+  }
+
+  //   ACK,<orderId>
+  //   FILL,<orderId>,<tradeId>,<price>,<quantity>
+  //   CANCELLED,<orderId>
+  //   REPLACED,<orderId>,<price>,<quantity>
+  //   REJECT,<orderId>,UNKNOWN_ORDER
+  void appendCsvReport(const ExecReport &r, double tickSize)
+  {
+    static const char *const kNames[] = {"ACK,", "FILL,", "CANCELLED,", "REPLACED,", "REJECT,"};
+    outbox_ += kNames[static_cast<int>(r.type)];
+    appendNumber(outbox_, r.orderId);
+    switch (r.type)
+    {
+    case ExecType::Fill:
+      outbox_ += ',';
+      appendNumber(outbox_, r.tradeId);
+      [[fallthrough]];
+    case ExecType::Replaced:
+      outbox_ += ',';
+      appendPrice(outbox_, r.price, tickSize);
+      outbox_ += ',';
+      appendNumber(outbox_, r.quantity);
+      break;
+    case ExecType::Rejected:
+      outbox_ += ",UNKNOWN_ORDER";
+      break;
+    default:
+      break;
+    }
+    outbox_ += '\n';
+  }
+
+  // Replies queued while a write is in flight go out together in the next.
+  // A client that sends orders but never reads the rejects is dropped.
+  void reply(const std::string &text)
+  {
+    if (!socket_.is_open())
+      return;
+    outbox_ += text;
+    if (tooFarBehind())
+      return;
+    if (writing_.empty())
+      flush();
+  }
+
+  void flush()
+  {
+    writing_.swap(outbox_);
+    asio::async_write(socket_, asio::buffer(writing_),
+                      [this, self = shared_from_this()](boost::system::error_code ec, size_t)
+                      {
+                        writing_.clear();
+                        if (ec)
+                          return close();
+                        if (!outbox_.empty())
+                          flush();
+                        else if (closing_)
+                          close();
+                      });
+  }
+
+  // True, after dropping the client, if more than maxUnsent bytes are
+  // waiting for it: its socket buffers are full and it is not reading.
+  bool tooFarBehind()
+  {
+    if (outbox_.size() + writing_.size() <= server_.maxUnsent_)
+      return false;
+    std::cerr << "Dropping order-entry client: " << outbox_.size() + writing_.size()
+              << " bytes unread\n";
+    closing_ = true;
+    close();
+    return true;
+  }
+
+  void close()
+  {
+    boost::system::error_code ignored;
+    socket_.shutdown(tcp::socket::shutdown_both, ignored);
+    socket_.close(ignored);
+    retry_.cancel();
+  }
+
+  OrderEntryServer &server_;
+  tcp::socket socket_;
+  WireFormat format_;
+  bool reports_;
+  asio::steady_timer retry_;
+  asio::streambuf buf_;
+  OrderParser parser_;
+  std::unique_ptr<ShardedEngine::Session> session_;
+  Order order_{};        // waiting for room while pending_
+  bool pending_ = false;
+  bool closing_ = false; // close once the outbox has been written
+  std::string outbox_;   // replies not yet handed to the socket
+  std::string writing_;  // replies being written
+};
+
+OrderEntryServer::OrderEntryServer(ShardedEngine &engines, unsigned short port,
+                                   size_t threads, size_t maxUnsent)
+    : engines_(engines),
+      threadCount_(std::max<size_t>(1, threads)),
+      maxUnsent_(maxUnsent),
+      ioc_(static_cast<int>(threadCount_)),
+      work_(asio::make_work_guard(ioc_))
+{
+  addListener(port, WireFormat::Csv, false);
+}
+
+unsigned short OrderEntryServer::addListener(unsigned short port, WireFormat format, bool reports)
+{
+  listeners_.push_back(std::make_unique<Listener>(ioc_, port, format, reports));
+  return listeners_.back()->acceptor.local_endpoint().port();
+}
+
+OrderEntryServer::~OrderEntryServer()
+{
+  stop();
+}
+
+void OrderEntryServer::start(std::function<void(size_t)> onThreadStart)
+{
+  for (auto &listener : listeners_)
+    accept(*listener);
+  for (size_t i = 0; i < threadCount_; ++i)
+    threads_.emplace_back([this, i, onThreadStart]
+                          {
+                            if (onThreadStart)
+                              onThreadStart(i);
+                            ioc_.run();
+                          });
+}
+
+void OrderEntryServer::stop()
+{
+  work_.reset();
+  ioc_.stop();
+  join();
+}
+
+void OrderEntryServer::join()
+{
+  for (auto &t : threads_)
+    if (t.joinable())
+      t.join();
+}
+
+unsigned short OrderEntryServer::port() const
+{
+  return listeners_.front()->acceptor.local_endpoint().port();
+}
+
+void OrderEntryServer::accept(Listener &listener)
+{
+  listener.acceptor.async_accept(
+      asio::make_strand(ioc_),
+      [this, &listener](boost::system::error_code ec, tcp::socket socket)
+      {
+        if (ec == asio::error::operation_aborted)
+          return;
+        if (!ec)
+        {
+          auto session = engines_.openSession();
+          if (session)
+            std::make_shared<Connection>(*this, std::move(socket), listener.format,
+                                         listener.reports, std::move(session))
+                ->start();
+          else
+            std::cerr << "Rejecting connection: session limit reached\n";
+        }
+        accept(listener);
+      });
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <boost/asio.hpp>
+#include "ShardedEngine.h"
+
+// How a listener's clients encode orders.
+//   Csv    - one line per order (see OrderParser)
+//   Binary - fixed-size messages (see BinaryProtocol.h)
+enum class WireFormat { Csv, Binary };
+
+// TCP order entry served by a fixed pool of I/O threads. Each
+// connection owns a ShardedEngine::Session and a bounded read buffer and is
+// driven by asynchronous reads on its own strand, so thousands of clients
+// cost a few kilobytes each instead of a thread each.
+//
+// When its session cannot take an order without waiting (lane full, or the
+// shard over its high-water mark under Backpressure), a connection stops
+// reading and retries on a short timer: the client sees TCP flow control
+// and the I/O thread goes on serving everyone else. Rejected and malformed
+// orders are answered with "REJECT,<orderId>,<reason>\n" on CSV listeners
+// and a RejectMsg on binary ones.
+//
+// On listeners added with `reports`, execution reports for a connection's
+// orders (acks, fills, cancel and replace confirmations, unknown-order
+// rejects) come back the same way: shard threads queue them on the session
+// and post one wakeup, and the connection's strand turns everything queued
+// into a single write. A client that does not read them fast enough (more
+// than `maxUnsent` bytes waiting for its socket, or a report ring overrun)
+// is disconnected. Other listeners send rejects only, so write-only feeders
+// never have to read.
+class OrderEntryServer
+{
+public:
+  // Listen for CSV on `port` (0 picks a free one) on all IPv4 interfaces,
+  // without execution reports.
+  OrderEntryServer(ShardedEngine &engines, unsigned short port, size_t threads = 2,
+                   size_t maxUnsent = 1 << 20);
+  ~OrderEntryServer();
+
+  OrderEntryServer(const OrderEntryServer &) = delete;
+  OrderEntryServer &operator=(const OrderEntryServer &) = delete;
+
+  // Also listen on `port` for `format`, served by the same I/O threads, with
+  // execution reports if `reports`. Call before start(); returns the port
+  // actually bound.
+  unsigned short addListener(unsigned short port, WireFormat format, bool reports = false);
+
+  // Start accepting and spawn the I/O threads; `onThreadStart(i)` runs first
+  // on I/O thread i (naming, placement).
+  void start(std::function<void(size_t)> onThreadStart = {});
+  // Drop every connection and join the I/O threads.
+  void stop();
+  // Block until the I/O threads exit.
+  void join();
+
+  // Port of the CSV listener given to the constructor.
+  unsigned short port() const;
+  size_t threads() const { return threadCount_; }
+  size_t connections() const { return connections_.load(std::memory_order_relaxed); }
+
+private:
+  class Connection;
+
+  struct Listener
+  {
+    Listener(boost::asio::io_context &ioc, unsigned short port, WireFormat format, bool reports)
+        : acceptor(ioc, {boost::asio::ip::tcp::v4(), port}), format(format), reports(reports) {}
+
+    boost::asio::ip::tcp::acceptor acceptor;
+    WireFormat format;
+    bool reports;
+  };
+
+  void accept(Listener &listener);
+
+  ShardedEngine &engines_;
+  size_t threadCount_;
+  size_t maxUnsent_; // per connection, bytes the client has not taken yet
+  // Declared before the io_context: handlers destroyed with it still hold
+  // connections, which count themselves out here.
+  std::atomic<size_t> connections_{0};
+  boost::asio::io_context ioc_;
+  boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work_;
+  std::vector<std::unique_ptr<Listener>> listeners_;
+  std::vector<std::thread> threads_;
+};
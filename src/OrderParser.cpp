@@ -0,0 +1,196 @@
+#include "OrderParser.h"
+#include <algorithm>
+#include <charconv>
+#include <limits>
+
+namespace
+{
+  // Fraction digits kept for tick conversion; later ones are validated and
+  // dropped (they are below a nano-unit).
+  constexpr size_t kMaxFractionDigits = 9;
+  constexpr uint64_t kPow10[] = {1, 10, 100, 1000, 10000, 100000, 1000000,
+                                 10000000, 100000000, 1000000000};
+
+  // Walks the comma-separated fields of one line.
+  class Fields
+  {
+  public:
+    explicit Fields(std::string_view line) : rest_(line) {}
+
+    bool next(std::string_view &field)
+    {
+      if (done_)
+        return false;
+      size_t comma = rest_.find(',');
+      if (comma == std::string_view::npos)
+      {
+        field = rest_;
+        done_ = true;
+      }
+      else
+      {
+        field = rest_.substr(0, comma);
+        rest_.remove_prefix(comma + 1);
+      }
+      return true;
+    }
+
+    bool done() const { return done_; }
+
+  private:
+    std::string_view rest_;
+    bool done_ = false;
+  };
+
+  // Whole field as an unsigned decimal: no sign, spaces or trailing junk.
+  template <class T>
+  bool toNumber(std::string_view s, T &out)
+  {
+    auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), out);
+    return ec == std::errc() && end == s.data() + s.size();
+  }
+
+  bool isDigits(std::string_view s)
+  {
+    return std::all_of(s.begin(), s.end(), [](char c)
+                       { return c >= '0' && c <= '9'; });
+  }
+
+  // "[-]digits[.digits]" to ticks, rounding half away from zero like
+  // toTicks(). Integer arithmetic whenever the tick divides the unit.
+  bool parsePrice(std::string_view s, double tickSize, Price &out)
+  {
+    bool negative = !s.empty() && s.front() == '-';
+    if (negative)
+      s.remove_prefix(1);
+    size_t dot = s.find('.');
+    std::string_view whole = s.substr(0, dot);
+    std::string_view frac = dot == std::string_view::npos ? std::string_view{} : s.substr(dot + 1);
+    if (whole.empty() && frac.empty())
+      return false;
+
+    uint64_t w = 0;
+    uint64_t f = 0;
+    size_t digits = std::min(frac.size(), kMaxFractionDigits);
+    if (!whole.empty() && !toNumber(whole, w))
+      return false;
+    if (!isDigits(frac) || (digits > 0 && !toNumber(frac.substr(0, digits), f)))
+      return false;
+
+    uint64_t scale = kPow10[digits];
+    int64_t perUnit = ticksPerUnit(tickSize);
+    auto unit = static_cast<uint64_t>(perUnit);
+    if (perUnit > 0 && unit <= kPow10[kMaxFractionDigits] &&
+        w < static_cast<uint64_t>(std::numeric_limits<Price>::max()) / unit - 1)
+    {
+      uint64_t part = f * unit; // < 10^18
+      uint64_t ticks = w * unit + part / scale;
+      if (2 * (part % scale) >= scale)
+        ++ticks;
+      out = negative ? -static_cast<Price>(ticks) : static_cast<Price>(ticks);
+    }
+    else
+    {
+      double price = static_cast<double>(w) + static_cast<double>(f) / static_cast<double>(scale);
+      out = toTicks(negative ? -price : price, tickSize);
+    }
+    return true;
+  }
+}
+
+const char *parseErrorName(ParseError error)
+{
+  switch (error)
+  {
+  case ParseError::None:
+    return "NONE";
+  case ParseError::MissingField:
+    return "MISSING_FIELD";
+  case ParseError::BadNumber:
+    return "BAD_NUMBER";
+  case ParseError::BadSide:
+    return "BAD_SIDE";
+  case ParseError::BadType:
+    return "BAD_TYPE";
+  case ParseError::BadPrice:
+    return "BAD_PRICE";
+  case ParseError::UnknownSymbol:
+    return "UNKNOWN_SYMBOL";
+  case ParseError::TrailingData:
+    return "TRAILING_DATA";
+  }
+  return "UNKNOWN";
+}
+
+SymbolId OrderParser::symbol(std::string_view name)
+{
+  if (name.empty() || name.size() > sizeof(CachedSymbol::name))
+    return name.empty() ? SymbolDirectory::kInvalid : symbols_.intern(name);
+
+  CachedSymbol &c = cache_[(name.front() * 31u + name.back() + name.size()) % cache_.size()];
+  if (c.size == name.size() && std::memcmp(c.name, name.data(), name.size()) == 0)
+    return c.id;
+  SymbolId id = symbols_.intern(name);
+  if (id != SymbolDirectory::kInvalid)
+  {
+    std::memcpy(c.name, name.data(), name.size());
+    c.size = static_cast<uint8_t>(name.size());
+    c.id = id;
+  }
+  return id;
+}
+
+ParseError OrderParser::parse(std::string_view line, Order &out)
+{
+  if (!line.empty() && line.back() == '\r')
+    line.remove_suffix(1);
+
+  Fields fields(line);
+  std::string_view f;
+  unsigned code = 0;
+  out.orderId = 0;
+
+  fields.next(f);
+  if (!toNumber(f, out.orderId))
+    return ParseError::BadNumber;
+
+  if (!fields.next(f))
+    return ParseError::MissingField;
+  if (!toNumber(f, out.accountId))
+    return ParseError::BadNumber;
+
+  if (!fields.next(f))
+    return ParseError::MissingField;
+  out.symbol = symbol(f);
+  if (out.symbol == SymbolDirectory::kInvalid)
+    return ParseError::UnknownSymbol;
+
+  if (!fields.next(f))
+    return ParseError::MissingField;
+  if (!toNumber(f, code) || code > static_cast<unsigned>(Side::SELL))
+    return ParseError::BadSide;
+  out.side = static_cast<Side>(code);
+
+  if (!fields.next(f))
+    return ParseError::MissingField;
+  if (!toNumber(f, code) || code > static_cast<unsigned>(OrderType::REPLACE))
+    return ParseError::BadType;
+  out.type = static_cast<OrderType>(code);
+
+  if (!fields.next(f))
+    return ParseError::MissingField;
+  if (!parsePrice(f, symbols_.tickSize(out.symbol), out.price))
+    return ParseError::BadPrice;
+
+  if (!fields.next(f))
+    return ParseError::MissingField;
+  if (!toNumber(f, out.quantity))
+    return ParseError::BadNumber;
+
+  if (!fields.next(f))
+    return ParseError::MissingField;
+  if (!toNumber(f, out.timestamp))
+    return ParseError::BadNumber;
+
+  return fields.done() ? ParseError::None : ParseError::TrailingData;
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include "Order.h"
+#include "SymbolDirectory.h"
+
+enum class ParseError : uint8_t
+{
+  None,
+  MissingField,  // fewer than eight comma-separated fields
+  BadNumber,     // id, account, quantity or timestamp not a decimal integer
+  BadSide,       // not 0 (buy) or 1 (sell)
+  BadType,       // not 0..3
+  BadPrice,      // not a plain decimal such as 150 or -0.25
+  UnknownSymbol, // empty, or the directory is full
+  TrailingData,  // more than eight fields
+};
+
+// "BAD_PRICE" etc., as sent back to clients.
+const char *parseErrorName(ParseError error);
+
+// Parser for the order-entry line format
+//   orderId,accountId,symbol,side,type,price,quantity,timestamp
+// that works in place on the receive buffer: fields are string_views into
+// it, numbers go through std::from_chars, and errors come back as codes.
+// Nothing allocates once a symbol has been seen, and nothing throws. Keep
+// one parser per connection: it caches symbol lookups.
+//
+// Prices are converted from their decimal digits, so "150.01" is exactly
+// 15001 ticks of 0.01 (rounded to the nearest tick when off-grid) rather
+// than whatever 150.01 / 0.01 comes to in floating point.
+class OrderParser
+{
+public:
+  explicit OrderParser(SymbolDirectory &symbols) : symbols_(symbols) {}
+
+  // One line, without its '\n' (a trailing '\r' is ignored). On error `out`
+  // is partly filled: orderId is set if that field parsed.
+  ParseError parse(std::string_view line, Order &out);
+
+  // Parse every complete line at the front of `data`. Calls
+  // onOrder(const Order &) for good lines, which returns false to stop after
+  // that line, and onError(ParseError, const Order &) for bad ones; blank
+  // lines are skipped. Returns the bytes consumed, up to and including the
+  // last newline handled.
+  template <class OnOrder, class OnError>
+  size_t parseLines(std::string_view data, OnOrder &&onOrder, OnError &&onError)
+  {
+    size_t used = 0;
+    Order o{};
+    for (;;)
+    {
+      const void *nl = std::memchr(data.data() + used, '\n', data.size() - used);
+      if (!nl)
+        return used;
+      size_t end = static_cast<const char *>(nl) - data.data();
+      std::string_view line = data.substr(used, end - used);
+      used = end + 1;
+      if (line.empty() || line == "\r")
+        continue;
+      ParseError error = parse(line, o);
+      if (error != ParseError::None)
+        onError(error, o);
+      else if (!onOrder(o))
+        return used;
+    }
+  }
+
+private:
+  // Recently seen symbols, so most lines skip the directory's lock and hash.
+  struct CachedSymbol
+  {
+    char name[15];
+    uint8_t size = 0;
+    SymbolId id = SymbolDirectory::kInvalid;
+  };
+
+  SymbolId symbol(std::string_view name);
+
+  SymbolDirectory &symbols_;
+  std::array<CachedSymbol, 16> cache_{};
+};
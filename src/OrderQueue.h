@@ -0,0 +1,77 @@
+#pragma once
+#include <cstdint>
+#include "Order.h"
+
+// A resting order. Nodes are linked directly into the FIFO of their price
+// level, so a node handle is enough to unlink an order in O(1).
+struct OrderNode
+{
+  uint64_t orderId;
+  uint64_t accountId;
+  Side     side;
+  uint32_t session;    // Order::session
+  Price    price;
+  uint64_t quantity;   // open quantity
+  uint64_t timestamp;
+
+  OrderNode *prev = nullptr;
+  OrderNode *next = nullptr;
+};
+
+// Intrusive doubly-linked FIFO of the orders resting at one price, with the
+// level's running totals kept alongside so snapshots never walk the orders.
+// The queue does not own its nodes and is safe to move around.
+class OrderQueue
+{
+public:
+  bool empty() const { return head_ == nullptr; }
+  OrderNode *head() const { return head_; }
+  OrderNode *tail() const { return tail_; }
+  OrderNode &front() { return *head_; }
+
+  uint64_t quantity() const { return quantity_; }
+  uint32_t count() const { return count_; }
+
+  void push_back(OrderNode *n)
+  {
+    quantity_ += n->quantity;
+    ++count_;
+    n->prev = tail_;
+    n->next = nullptr;
+    if (tail_)
+      tail_->next = n;
+    else
+      head_ = n;
+    tail_ = n;
+  }
+
+  void pop_front() { erase(head_); }
+
+  // Partial fill or size reduction: the order keeps its place in the queue.
+  void reduce(OrderNode *n, uint64_t by)
+  {
+    n->quantity -= by;
+    quantity_ -= by;
+  }
+
+  void erase(OrderNode *n)
+  {
+    quantity_ -= n->quantity;
+    --count_;
+    if (n->prev)
+      n->prev->next = n->next;
+    else
+      head_ = n->next;
+    if (n->next)
+      n->next->prev = n->prev;
+    else
+      tail_ = n->prev;
+    n->prev = n->next = nullptr;
+  }
+
+private:
+  OrderNode *head_ = nullptr;
+  OrderNode *tail_ = nullptr;
+  uint64_t quantity_ = 0;
+  uint32_t count_ = 0;
+};
@@ -0,0 +1,39 @@
+#include "Pool.h"
+#include <algorithm>
+
+namespace
+{
+  constexpr size_t kAlign = alignof(std::max_align_t);
+}
+
+SlabPool::SlabPool(size_t blockSize, size_t blocksPerSlab)
+    : blockSize_((std::max(blockSize, sizeof(FreeBlock)) + kAlign - 1) / kAlign * kAlign),
+      blocksPerSlab_(blocksPerSlab)
+{
+}
+
+SlabPool::~SlabPool()
+{
+  for (void *slab : slabs_)
+    ::operator delete(slab);
+}
+
+void SlabPool::reserve(size_t blocks)
+{
+  if (blocks > capacity_)
+    grow(blocks - capacity_);
+}
+
+void SlabPool::grow(size_t blocks)
+{
+  auto *slab = static_cast<char *>(::operator new(blocks * blockSize_));
+  slabs_.push_back(slab);
+  // Thread the new blocks onto the free list in address order.
+  for (size_t i = blocks; i-- > 0;)
+  {
+    auto *b = reinterpret_cast<FreeBlock *>(slab + i * blockSize_);
+    b->next = free_;
+    free_ = b;
+  }
+  capacity_ += blocks;
+}
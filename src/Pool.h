@@ -0,0 +1,136 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Fixed-size block allocator. Memory is carved out of large slabs and
+// recycled through an intrusive free list, so once capacity is reserved
+// allocate()/deallocate() never reach malloc. Not thread-safe: pools belong
+// to a single engine thread.
+class SlabPool
+{
+public:
+  explicit SlabPool(size_t blockSize, size_t blocksPerSlab = 4096);
+  ~SlabPool();
+
+  SlabPool(const SlabPool &) = delete;
+  SlabPool &operator=(const SlabPool &) = delete;
+
+  // Make sure at least `blocks` blocks exist in total.
+  void reserve(size_t blocks);
+
+  void *allocate()
+  {
+    if (!free_)
+      grow(blocksPerSlab_);
+    FreeBlock *b = free_;
+    free_ = b->next;
+    ++inUse_;
+    return b;
+  }
+
+  void deallocate(void *p)
+  {
+    auto *b = static_cast<FreeBlock *>(p);
+    b->next = free_;
+    free_ = b;
+    --inUse_;
+  }
+
+  size_t blockSize() const { return blockSize_; }
+  size_t capacity() const { return capacity_; }
+  size_t inUse() const { return inUse_; }
+  size_t slabs() const { return slabs_.size(); }
+
+private:
+  struct FreeBlock
+  {
+    FreeBlock *next;
+  };
+
+  size_t blockSize_;
+  size_t blocksPerSlab_;
+  size_t capacity_ = 0;
+  size_t inUse_ = 0;
+  FreeBlock *free_ = nullptr;
+  std::vector<void *> slabs_;
+
+  void grow(size_t blocks);
+};
+
+// Typed front end over a SlabPool.
+template <class T>
+class ObjectPool
+{
+public:
+  static_assert(alignof(T) <= alignof(std::max_align_t), "over-aligned type");
+
+  explicit ObjectPool(size_t reserve = 0) : slab_(sizeof(T)) { slab_.reserve(reserve); }
+
+  template <class... Args>
+  T *create(Args &&...args)
+  {
+    return new (slab_.allocate()) T{std::forward<Args>(args)...};
+  }
+
+  void destroy(T *p)
+  {
+    p->~T();
+    slab_.deallocate(p);
+  }
+
+  const SlabPool &slab() const { return slab_; }
+
+private:
+  SlabPool slab_;
+};
+
+// Block size that fits one node of a std node-based container holding `V`:
+// the value plus up to four pointers' worth of links/colour/hash.
+template <class V>
+constexpr size_t nodeBlockSize()
+{
+  return sizeof(V) + 4 * sizeof(void *);
+}
+
+// std-compatible allocator that serves single-node allocations (map and
+// unordered_map nodes) from a SlabPool and anything else (bucket arrays,
+// nodes too big for the pool's blocks) from the global heap.
+template <class T>
+struct PoolAllocator
+{
+  using value_type = T;
+
+  SlabPool *pool;
+
+  explicit PoolAllocator(SlabPool *p) noexcept : pool(p) {}
+  template <class U>
+  PoolAllocator(const PoolAllocator<U> &other) noexcept : pool(other.pool) {}
+
+  T *allocate(size_t n)
+  {
+    if (pooled(n))
+      return static_cast<T *>(pool->allocate());
+    return static_cast<T *>(::operator new(n * sizeof(T)));
+  }
+
+  void deallocate(T *p, size_t n) noexcept
+  {
+    if (pooled(n))
+      pool->deallocate(p);
+    else
+      ::operator delete(p);
+  }
+
+  bool pooled(size_t n) const
+  {
+    return n == 1 && sizeof(T) <= pool->blockSize() &&
+           alignof(T) <= alignof(std::max_align_t);
+  }
+
+  template <class U>
+  bool operator==(const PoolAllocator<U> &other) const { return pool == other.pool; }
+  template <class U>
+  bool operator!=(const PoolAllocator<U> &other) const { return pool != other.pool; }
+};
@@ -0,0 +1,36 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+
+// Prices are carried as signed integer ticks; the tick size of the symbol
+// converts them back to a decimal price at the edges (parsing, HTTP, Kafka).
+using Price = int64_t;
+
+// Largest price accepted off the wire: 2^53 ticks still converts to a
+// double exactly, and differences of valid prices cannot overflow.
+constexpr Price kMaxPrice = Price{1} << 53;
+
+inline Price toTicks(double price, double tickSize)
+{
+  return static_cast<Price>(std::llround(price / tickSize));
+}
+
+// Ticks per unit of price when that is a whole number (0.01 → 100,
+// 0.25 → 4), else 0.
+inline int64_t ticksPerUnit(double tickSize)
+{
+  double perUnit = 1.0 / tickSize;
+  double rounded = std::round(perUnit);
+  if (std::abs(perUnit - rounded) < 1e-9)
+    return static_cast<int64_t>(rounded);
+  return 0;
+}
+
+inline double fromTicks(Price ticks, double tickSize)
+{
+  // Divide by the tick count per unit when it is integral (0.01 → 100) so
+  // that e.g. 15001 ticks prints as 150.01 rather than 150.01000000000002.
+  if (int64_t perUnit = ticksPerUnit(tickSize))
+    return static_cast<double>(ticks) / static_cast<double>(perUnit);
+  return static_cast<double>(ticks) * tickSize;
+}
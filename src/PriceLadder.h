@@ -0,0 +1,318 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
+#include <vector>
+#include "OrderQueue.h"
+#include "Pool.h"
+#include "TickBitmap.h"
+
+// Storage for one side of a book: price → OrderQueue of resting orders,
+// ordered so that the best price comes first under `Better` (std::greater<>
+// for bids, std::less<> for asks). OrderBook is written against this small
+// interface:
+//
+//   empty(), bestPrice(), best(), popBest()   top-of-book access
+//   push(price, node)                         append to the level at `price`
+//   find(price), erase(price)                 lookup / drop an emptied level
+//   forEach(depth, f)                         visit levels best-first until
+//                                             `depth` or f(price, queue)
+//                                             returns false
+
+struct LadderConfig
+{
+  size_t ticks = 4096;         // initial window of an ArrayLadder
+  size_t maxTicks = 1u << 20;  // never grow the window past this many ticks
+};
+
+// Red-black tree ladder: one node per price level, drawn from `nodes`.
+template <class Better>
+class MapLadder
+{
+public:
+  using Queue = OrderQueue;
+  using Levels = std::map<Price, Queue, Better,
+                          PoolAllocator<std::pair<const Price, Queue>>>;
+
+  static constexpr size_t kNodeSize = nodeBlockSize<typename Levels::value_type>();
+
+  MapLadder(const LadderConfig &, SlabPool *nodes)
+      : levels_(Better{}, typename Levels::allocator_type(nodes))
+  {
+  }
+
+  bool empty() const { return levels_.empty(); }
+  Price bestPrice() const { return levels_.begin()->first; }
+  Queue &best() { return levels_.begin()->second; }
+  void popBest() { levels_.erase(levels_.begin()); }
+
+  void push(Price price, OrderNode *n) { levels_[price].push_back(n); }
+
+  Queue *find(Price price)
+  {
+    auto it = levels_.find(price);
+    return it == levels_.end() ? nullptr : &it->second;
+  }
+  void erase(Price price) { levels_.erase(price); }
+
+  template <class F>
+  void forEach(size_t depth, F &&f) const
+  {
+    for (auto it = levels_.begin(); it != levels_.end() && depth > 0; ++it, --depth)
+    {
+      if (!f(it->first, it->second))
+        return;
+    }
+  }
+
+  typename Levels::const_iterator begin() const { return levels_.begin(); }
+  typename Levels::const_iterator end() const { return levels_.end(); }
+  typename Levels::iterator begin() { return levels_.begin(); }
+  typename Levels::iterator end() { return levels_.end(); }
+
+private:
+  Levels levels_;
+};
+
+// Dense ladder: levels live in a contiguous array indexed by tick offset from
+// a movable anchor (`base_`). A cursor tracks the best occupied index and a
+// TickBitmap of occupied ticks finds the next best level in a few
+// instructions however many empty ticks lie in between. When a price falls
+// outside the window the ladder recenters around the occupied range,
+// doubling the window (up to maxTicks) if needed; levels that still do not
+// fit spill into a small overflow map so no order is ever refused.
+template <class Better>
+class ArrayLadder
+{
+public:
+  using Queue = OrderQueue;
+
+  ArrayLadder(const LadderConfig &cfg, SlabPool *nodes)
+      : levels_(cfg.ticks), occupied_(cfg.ticks),
+        maxTicks_(std::max(cfg.maxTicks, cfg.ticks)), far_(cfg, nodes)
+  {
+  }
+
+  bool empty() const { return live_ == 0 && far_.empty(); }
+
+  Price bestPrice() const
+  {
+    if (live_ == 0)
+      return far_.bestPrice();
+    Price p = priceAt(best_);
+    if (!far_.empty() && Better{}(far_.bestPrice(), p))
+      return far_.bestPrice();
+    return p;
+  }
+
+  Queue &best()
+  {
+    if (live_ == 0 || (!far_.empty() && Better{}(far_.bestPrice(), priceAt(best_))))
+      return far_.best();
+    return levels_[best_];
+  }
+
+  void popBest() { erase(bestPrice()); }
+
+  void push(Price price, OrderNode *n)
+  {
+    if (live_ == 0 && !inWindow(price))
+      anchor(price);
+    else if (!inWindow(price) && !recenter(price))
+    {
+      far_.push(price, n);
+      return;
+    }
+    size_t i = index(price);
+    if (!occupied_.test(i))
+      occupy(i);
+    levels_[i].push_back(n);
+  }
+
+  Queue *find(Price price)
+  {
+    if (inWindow(price))
+    {
+      size_t i = index(price);
+      return occupied_.test(i) ? &levels_[i] : nullptr;
+    }
+    return far_.find(price);
+  }
+
+  void erase(Price price)
+  {
+    if (!inWindow(price))
+    {
+      far_.erase(price);
+      return;
+    }
+    size_t i = index(price);
+    occupied_.clear(i);
+    --live_;
+    if (live_ > 0 && i == best_)
+      best_ = nextOccupied(i);
+    else if (live_ == 0 && !far_.empty())
+      anchor(far_.bestPrice());
+  }
+
+  template <class F>
+  void forEach(size_t depth, F &&f) const
+  {
+    auto fit = far_.begin();
+    size_t remaining = live_;
+    size_t i = best_;
+    while (depth > 0 && (remaining > 0 || fit != far_.end()))
+    {
+      bool takeFar = fit != far_.end() &&
+                     (remaining == 0 || Better{}(fit->first, priceAt(i)));
+      if (takeFar)
+      {
+        if (!f(fit->first, fit->second))
+          return;
+        ++fit;
+      }
+      else
+      {
+        if (!f(priceAt(i), levels_[i]))
+          return;
+        if (--remaining > 0)
+          i = nextOccupied(i);
+      }
+      --depth;
+    }
+  }
+
+  Price anchorPrice() const { return base_; }
+  size_t windowTicks() const { return levels_.size(); }
+
+private:
+  static constexpr bool kHigherIsBetter = Better{}(1, 0);
+
+  std::vector<Queue> levels_; // levels_[i] holds price base_ + i
+  TickBitmap occupied_;       // bit i set iff levels_[i] is non-empty
+  Price base_ = 0;
+  size_t live_ = 0;           // occupied levels inside the window
+  size_t best_ = 0;           // index of the best occupied level, if live_ > 0
+  size_t maxTicks_;
+  MapLadder<Better> far_;     // levels outside the window
+
+  // Ticks from `lo` up to `hi` (hi >= lo). Unsigned, so any two prices
+  // are a representable distance apart.
+  static uint64_t distance(Price lo, Price hi)
+  {
+    return static_cast<uint64_t>(hi) - static_cast<uint64_t>(lo);
+  }
+
+  bool inWindow(Price p) const { return p >= base_ && distance(base_, p) < levels_.size(); }
+  size_t index(Price p) const { return static_cast<size_t>(distance(base_, p)); }
+  Price priceAt(size_t i) const { return base_ + static_cast<Price>(i); }
+
+  // A window start `offset` ticks below `price`, moved up or down as needed
+  // so that every price in a window of `size` ticks is representable.
+  static Price baseFor(Price price, size_t offset, size_t size)
+  {
+    constexpr Price lowest = std::numeric_limits<Price>::min();
+    constexpr Price highest = std::numeric_limits<Price>::max();
+    Price base = distance(lowest, price) < offset ? lowest : price - static_cast<Price>(offset);
+    return std::min(base, highest - static_cast<Price>(size - 1));
+  }
+
+  bool betterIndex(size_t a, size_t b) const
+  {
+    return kHigherIsBetter ? a > b : a < b;
+  }
+
+  void occupy(size_t i)
+  {
+    occupied_.set(i);
+    if (live_ == 0 || betterIndex(i, best_))
+      best_ = i;
+    ++live_;
+  }
+
+  // Next occupied index strictly worse than `from`; one must exist.
+  size_t nextOccupied(size_t from) const
+  {
+    return kHigherIsBetter ? occupied_.findPrev(from - 1)
+                           : occupied_.findNext(from + 1);
+  }
+
+  // Empty window: move the anchor so that `price` sits in the middle.
+  void anchor(Price price)
+  {
+    base_ = baseFor(price, levels_.size() / 2, levels_.size());
+    absorbFar();
+  }
+
+  // Rebuild the window so it covers every occupied level plus `price`.
+  bool recenter(Price price)
+  {
+    Price lo = price, hi = price;
+    if (live_ > 0)
+    {
+      lo = std::min(lo, priceAt(occupied_.findNext(0)));
+      hi = std::max(hi, priceAt(occupied_.findPrev(levels_.size() - 1)));
+    }
+    if (distance(lo, hi) >= maxTicks_)
+      return false;
+    size_t span = static_cast<size_t>(distance(lo, hi)) + 1;
+    size_t size = levels_.size();
+    while (span > size / 2 && size < maxTicks_)
+      size = std::min(size * 2, maxTicks_);
+    if (span > size)
+      return false;
+
+    Price newBase = baseFor(lo, (size - span) / 2, size);
+    std::vector<Queue> moved(size);
+    TickBitmap movedBits(size);
+    for (size_t i = occupied_.findNext(0); i != TickBitmap::npos;
+         i = occupied_.findNext(i + 1))
+    {
+      size_t j = static_cast<size_t>(distance(newBase, priceAt(i)));
+      moved[j] = std::move(levels_[i]);
+      movedBits.set(j);
+    }
+    if (live_ > 0)
+      best_ = static_cast<size_t>(distance(newBase, priceAt(best_)));
+    levels_ = std::move(moved);
+    occupied_ = std::move(movedBits);
+    base_ = newBase;
+    absorbFar();
+    return true;
+  }
+
+  // Pull overflow levels that the current window now covers into the array.
+  void absorbFar()
+  {
+    for (auto it = far_.begin(); it != far_.end();)
+    {
+      if (!inWindow(it->first))
+      {
+        ++it;
+        continue;
+      }
+      size_t i = index(it->first);
+      levels_[i] = std::move(it->second);
+      occupy(i);
+      Price p = it->first;
+      ++it;
+      far_.erase(p);
+    }
+  }
+};
+
+// Ladder families an OrderBook can be instantiated with.
+struct MapLadders
+{
+  template <class Better>
+  using Side = MapLadder<Better>;
+};
+
+struct ArrayLadders
+{
+  template <class Better>
+  using Side = ArrayLadder<Better>;
+};
@@ -0,0 +1,71 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include "WaitStrategy.h"
+
+// Single-writer sequence lock around a trivially copyable value. The writer
+// never waits; readers retry if a store overlapped their copy. The value is
+// held as relaxed atomic words so concurrent copies are well-defined.
+template <class T>
+class Seqlock
+{
+public:
+  static_assert(std::is_trivially_copyable_v<T>, "Seqlock needs a trivially copyable type");
+
+  // Writer only.
+  void store(const T &v)
+  {
+    uint64_t seq = seq_.load(std::memory_order_relaxed);
+    seq_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    uint64_t word;
+    const char *src = reinterpret_cast<const char *>(&v);
+    for (size_t i = 0; i < kWords; ++i)
+    {
+      word = 0;
+      std::memcpy(&word, src + i * 8, i + 1 < kWords ? 8 : kTail);
+      words_[i].store(word, std::memory_order_relaxed);
+    }
+    seq_.store(seq + 2, std::memory_order_release);
+  }
+
+  // Copy out a consistent value. Returns how many stores it reflects
+  // (0: never stored, `out` untouched).
+  uint64_t load(T &out) const
+  {
+    for (;;)
+    {
+      uint64_t before = seq_.load(std::memory_order_acquire);
+      if (before == 0)
+        return 0;
+      if (before & 1)
+      {
+        cpuRelax();
+        continue;
+      }
+      char buf[sizeof(T)];
+      uint64_t word;
+      for (size_t i = 0; i < kWords; ++i)
+      {
+        word = words_[i].load(std::memory_order_relaxed);
+        std::memcpy(buf + i * 8, &word, i + 1 < kWords ? 8 : kTail);
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (seq_.load(std::memory_order_relaxed) == before)
+      {
+        std::memcpy(static_cast<void *>(&out), buf, sizeof(T));
+        return before / 2;
+      }
+    }
+  }
+
+private:
+  static constexpr size_t kWords = (sizeof(T) + 7) / 8;
+  static constexpr size_t kTail = sizeof(T) - (kWords - 1) * 8;
+
+  std::atomic<uint64_t> seq_{0}; // odd while a store is in progress
+  std::atomic<uint64_t> words_[kWords]{};
+};
@@ -0,0 +1,118 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include "WaitStrategy.h"
+
+// Disruptor-style multi-producer/single-consumer ring. Slots are
+// preallocated; a producer claims a sequence number, writes the slot in
+// place and publishes it, and the consumer reads slots in sequence order
+// straight out of the ring. Each slot carries the sequence it was last
+// published under, so producers that finish out of order never expose a
+// half-written slot. Cursors sit on their own cache lines.
+template <class T>
+class SequencedRing
+{
+public:
+  // Capacity is rounded up to a power of two.
+  explicit SequencedRing(size_t capacity)
+  {
+    size_t n = 2;
+    while (n < capacity)
+      n <<= 1;
+    capacity_ = n;
+    mask_ = n - 1;
+    slots_.reset(new Slot[n]);
+    for (size_t i = 0; i < n; ++i)
+      slots_[i].published.store(-1, std::memory_order_relaxed);
+  }
+
+  SequencedRing(const SequencedRing &) = delete;
+  SequencedRing &operator=(const SequencedRing &) = delete;
+
+  size_t capacity() const { return capacity_; }
+
+  // Producers: claim the next sequence, or return false if the ring is full.
+  bool tryClaim(int64_t &seq)
+  {
+    int64_t next = claimed_.load(std::memory_order_relaxed);
+    for (;;)
+    {
+      if (next - static_cast<int64_t>(capacity_) >= consumed_.load(std::memory_order_acquire))
+        return false;
+      if (claimed_.compare_exchange_weak(next, next + 1, std::memory_order_relaxed))
+      {
+        seq = next;
+        return true;
+      }
+    }
+  }
+
+  // Producers: claim, waiting for the consumer while the ring is full.
+  int64_t claim()
+  {
+    int64_t seq;
+    for (unsigned i = 0; !tryClaim(seq); ++i)
+    {
+      if (i < 1024)
+        cpuRelax();
+      else
+        std::this_thread::yield();
+    }
+    return seq;
+  }
+
+  // The slot for a claimed (producer) or available (consumer) sequence.
+  T &operator[](int64_t seq) { return slots_[seq & mask_].value; }
+
+  void publish(int64_t seq)
+  {
+    slots_[seq & mask_].published.store(seq, std::memory_order_release);
+  }
+
+  // Consumer: whether the next sequence has been published.
+  bool available() const
+  {
+    return slots_[next_ & mask_].published.load(std::memory_order_acquire) == next_;
+  }
+
+  // Consumer: hand up to `max` published slots, in sequence order, to
+  // f(const T&), then release them to producers. Returns how many.
+  template <class F>
+  size_t poll(F &&f, size_t max)
+  {
+    size_t n = 0;
+    while (n < max && available())
+    {
+      f(slots_[next_ & mask_].value);
+      ++next_;
+      ++n;
+    }
+    if (n)
+      consumed_.store(next_, std::memory_order_release);
+    return n;
+  }
+
+  // Approximate number of claimed but unconsumed slots.
+  size_t size_approx() const
+  {
+    return static_cast<size_t>(claimed_.load(std::memory_order_relaxed) -
+                               consumed_.load(std::memory_order_relaxed));
+  }
+
+private:
+  struct Slot
+  {
+    std::atomic<int64_t> published;
+    T value;
+  };
+
+  size_t capacity_;
+  size_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+
+  alignas(64) std::atomic<int64_t> claimed_{0};  // next sequence to claim
+  alignas(64) std::atomic<int64_t> consumed_{0}; // first unconsumed sequence
+  alignas(64) int64_t next_ = 0;                 // consumer's read position
+};
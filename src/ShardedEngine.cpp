@@ -0,0 +1,605 @@
+#include "ShardedEngine.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <thread>
+
+namespace
+{
+  // Single-writer counter that other threads may read.
+  void bump(std::atomic<uint64_t> &counter, uint64_t by)
+  {
+    counter.store(counter.load(std::memory_order_relaxed) + by,
+                  std::memory_order_relaxed);
+  }
+}
+
+IngressMode parseIngressMode(const std::string &name)
+{
+  return name == "ring" ? IngressMode::Ring : IngressMode::Lanes;
+}
+
+OverloadPolicy parseOverloadPolicy(const std::string &name)
+{
+  return name == "reject" ? OverloadPolicy::Reject : OverloadPolicy::Backpressure;
+}
+
+const char *rejectReasonName(RejectReason reason)
+{
+  switch (reason)
+  {
+  case RejectReason::None:
+    return "NONE";
+  case RejectReason::Overloaded:
+    return "OVERLOADED";
+  }
+  return "UNKNOWN";
+}
+
+ShardedEngine::ShardedEngine(size_t shards,
+                             std::shared_ptr<SymbolDirectory> symbols,
+                             const PoolConfig &pools,
+                             WaitMode wait,
+                             const IngressConfig &ingress)
+    : ingress_(ingress),
+      slots_(new SessionSlot[ingress.maxSessions]),
+      symbols_(std::move(symbols)),
+      views_(symbols_->capacity()),
+      routes_(new std::atomic<uint32_t>[symbols_->capacity()])
+{
+  if (shards == 0)
+    shards = 1;
+  for (size_t i = 0; i < symbols_->capacity(); ++i)
+    routes_[i].store(kUnrouted, std::memory_order_relaxed);
+
+  shards_.reserve(shards);
+  for (size_t i = 0; i < shards; ++i)
+  {
+    shards_.push_back(std::make_unique<Shard>(symbols_, pools, wait));
+    shards_.back()->engine.setTradeIds(i + 1, shards);
+    if (ingress_.mode == IngressMode::Ring)
+      shards_.back()->ring = std::make_unique<SequencedRing<Order>>(ingress_.ringCapacity);
+    shards_.back()->waking.resize(ingress_.maxSessions);
+    shards_.back()->toWake.reserve(ingress_.maxSessions);
+  }
+}
+
+size_t ShardedEngine::shardOf(SymbolId symbol) const
+{
+  uint32_t shard = routes_[symbol].load(std::memory_order_relaxed);
+  if (shard != kUnrouted)
+    return shard;
+
+  // Racing threads compute the same answer, so a plain store is enough.
+  const SymbolSpec &spec = symbols_->spec(symbol);
+  if (spec.shard >= 0)
+    shard = static_cast<uint32_t>(spec.shard) % shards_.size();
+  else
+    shard = std::hash<std::string>{}(symbols_->name(symbol)) % shards_.size();
+  routes_[symbol].store(shard, std::memory_order_relaxed);
+  return shard;
+}
+
+bool ShardedEngine::overloaded(const Shard &shard, const Order &order) const
+{
+  // Cancels and replaces only touch resting orders, and relieve a backed-up
+  // book rather than add to it.
+  return ingress_.highWater != 0 && order.type != OrderType::CANCEL &&
+         order.type != OrderType::REPLACE &&
+         shard.depth.load(std::memory_order_relaxed) >=
+             static_cast<int64_t>(ingress_.highWater);
+}
+
+bool ShardedEngine::admit(Shard &shard, const Order &order, bool wait,
+                          RejectReason &reason)
+{
+  reason = RejectReason::None;
+  if (!overloaded(shard, order))
+    return true;
+  if (ingress_.overload == OverloadPolicy::Reject)
+  {
+    shard.rejected.fetch_add(1, std::memory_order_relaxed);
+    reason = RejectReason::Overloaded;
+    return false;
+  }
+  if (!wait)
+    return false;
+  while (overloaded(shard, order))
+  {
+    shard.wait.notify();
+    std::this_thread::yield();
+  }
+  return true;
+}
+
+std::unique_ptr<ShardedEngine::Session> ShardedEngine::openSession()
+{
+  std::lock_guard<std::mutex> lock(sessionsMutex_);
+  size_t used = slotsInUse_.load(std::memory_order_relaxed);
+
+  // Reuse a closed slot whose lanes have been drained, else take a new one.
+  size_t slot = used;
+  for (size_t i = 0; i < used && slot == used; ++i)
+  {
+    SessionSlot &s = slots_[i];
+    if (s.state.load(std::memory_order_acquire) != kClosed)
+      continue;
+    bool drained = std::all_of(s.lanes.begin(), s.lanes.end(), [](const auto &lane)
+                               { return lane->empty(); });
+    if (drained)
+      slot = i;
+  }
+  if (slot == ingress_.maxSessions)
+    return nullptr;
+
+  SessionSlot &s = slots_[slot];
+  if (slot == used)
+  {
+    // In ring mode lanes only carry the session's counters.
+    bool ring = ingress_.mode == IngressMode::Ring;
+    size_t capacity = ring ? 2 : ingress_.laneCapacity;
+    size_t cancelCapacity = ring ? 2 : ingress_.cancelCapacity;
+    for (size_t k = 0; k < shards_.size(); ++k)
+      s.lanes.push_back(std::make_unique<Lane>(capacity, cancelCapacity,
+                                               ingress_.reportCapacity));
+    s.enqueuedAtOpen.reset(new std::atomic<uint64_t>[shards_.size()]);
+  }
+  for (size_t k = 0; k < shards_.size(); ++k)
+    s.enqueuedAtOpen[k].store(s.lanes[k]->enqueued.load(std::memory_order_relaxed),
+                              std::memory_order_relaxed);
+  // Reports for the previous session are of no use to the next; any still
+  // in flight are filtered out by id in pollReports().
+  ExecReport stale;
+  for (auto &lane : s.lanes)
+    while (lane->reports.try_pop(stale))
+    {
+    }
+  s.reportsDropped.store(0, std::memory_order_relaxed);
+  s.wakePending.store(false, std::memory_order_relaxed);
+
+  // The id says which slot it has, so shard threads can route reports
+  // without a lookup table.
+  uint32_t generations = std::numeric_limits<uint32_t>::max() / ingress_.maxSessions;
+  uint32_t id = static_cast<uint32_t>((nextSession_++ % generations) * ingress_.maxSessions + slot + 1);
+  s.session.store(id, std::memory_order_relaxed);
+  s.state.store(kOpen, std::memory_order_release);
+  if (slot == used)
+    slotsInUse_.store(used + 1, std::memory_order_release);
+
+  return std::unique_ptr<Session>(new Session(*this, slot, id));
+}
+
+ShardedEngine::Session::~Session()
+{
+  SessionSlot &slot = engines_.slots_[slot_];
+  slot.reporting.store(false, std::memory_order_relaxed);
+  std::atomic_store(&slot.wake, std::shared_ptr<const std::function<void()>>());
+  slot.state.store(kClosed, std::memory_order_release);
+}
+
+void ShardedEngine::Session::onReports(std::function<void()> wake)
+{
+  SessionSlot &slot = engines_.slots_[slot_];
+  std::atomic_store(&slot.wake,
+                    std::shared_ptr<const std::function<void()>>(
+                        std::make_shared<const std::function<void()>>(std::move(wake))));
+  slot.reporting.store(true, std::memory_order_release);
+}
+
+uint64_t ShardedEngine::Session::reportsDropped() const
+{
+  return engines_.slots_[slot_].reportsDropped.load(std::memory_order_relaxed);
+}
+
+RejectReason ShardedEngine::Session::submit(const Order &order)
+{
+  RejectReason reason;
+  enqueue(order, true, reason);
+  return reason;
+}
+
+bool ShardedEngine::Session::trySubmit(const Order &order, RejectReason &reason)
+{
+  return enqueue(order, false, reason) || reason != RejectReason::None;
+}
+
+bool ShardedEngine::Session::enqueue(const Order &submitted, bool wait, RejectReason &reason)
+{
+  Order order = submitted;
+  order.session = id_;
+  size_t k = engines_.shardOf(order.symbol);
+  Shard &shard = *engines_.shards_[k];
+  Lane &lane = *engines_.slots_[slot_].lanes[k];
+  if (!engines_.admit(shard, order, wait, reason))
+    return false;
+
+  // Lane full: this client waits (or comes back later); nobody else does.
+  auto push = [&](auto &ring, const auto &item)
+  {
+    while (!ring.try_push(item))
+    {
+      if (!wait)
+        return false;
+      shard.wait.notify();
+      std::this_thread::yield();
+    }
+    return true;
+  };
+
+  shard.depth.fetch_add(1, std::memory_order_relaxed);
+  bool queued = true;
+  if (shard.ring)
+  {
+    int64_t seq = 0;
+    if (wait)
+      seq = shard.ring->claim();
+    else
+      queued = shard.ring->tryClaim(seq);
+    if (queued)
+    {
+      (*shard.ring)[seq] = order;
+      shard.ring->publish(seq);
+    }
+  }
+  else if (order.type == OrderType::CANCEL || order.type == OrderType::REPLACE)
+  {
+    queued = push(lane.cancels, QueuedCancel{order, lane.pushed});
+  }
+  else
+  {
+    queued = push(lane.ring, order);
+    lane.pushed += queued;
+  }
+  if (!queued)
+  {
+    shard.depth.fetch_sub(1, std::memory_order_relaxed);
+    shard.wait.notify();
+    return false;
+  }
+  lane.enqueued.store(lane.enqueued.load(std::memory_order_relaxed) + 1,
+                      std::memory_order_relaxed);
+  shard.wait.notify();
+  return true;
+}
+
+size_t ShardedEngine::drain(size_t shard, Order *out, size_t max)
+{
+  Shard &s = *shards_[shard];
+  size_t quantum = std::max<size_t>(1, ingress_.quantum);
+  // The shared queue takes a turn first, like one more session.
+  size_t n = s.queue.try_dequeue_bulk(out, std::min(max, quantum));
+
+  if (s.ring)
+    s.ring->poll([&](const Order &o)
+                 { out[n++] = o; },
+                 max - n);
+
+  size_t slots = s.ring ? 0 : slotsInUse_.load(std::memory_order_acquire);
+  size_t removed = 0; // queued orders cancelled before reaching the engine
+
+  // Every session's cancels and replaces go ahead of all new orders.
+  for (size_t i = 0; i < slots && n < max; ++i)
+  {
+    SessionSlot &slot = slots_[i];
+    if (slot.state.load(std::memory_order_acquire) == kFree)
+      continue;
+    Lane &lane = *slot.lanes[shard];
+    size_t first = n;
+    QueuedCancel c;
+    while (n < max && lane.cancels.try_pop(c))
+    {
+      ParkedKey key{i, c.order.orderId};
+      auto it = s.parked.find(key);
+      bool ahead = c.after > lane.passed();
+      if (ahead)
+      {
+        // Its target may still be queued behind it in this session's lane,
+        // or be the order held back for it.
+        bump(s.cancelsAhead, 1);
+        bump(s.overtaken, c.after - lane.passed());
+        if (it == s.parked.end())
+        {
+          // Earlier cancels for the same target in this pass go on the
+          // list too, so the engine's verdicts are matched up in order.
+          it = s.parked.emplace(key, std::vector<ParkedCancel>{}).first;
+          for (size_t j = first; j < n; ++j)
+            if (out[j].orderId == key.orderId)
+              it->second.push_back({0, out[j], true});
+        }
+      }
+      if (it != s.parked.end())
+        it->second.push_back({c.after, c.order, !ahead});
+      out[n++] = c.order;
+    }
+  }
+
+  if (slots > 0)
+  {
+    // One quantum per session per pass, starting one session further on at
+    // every call so no lane is always served first.
+    size_t start = s.cursor++ % slots;
+    for (bool progress = true; progress && n < max;)
+    {
+      progress = false;
+      for (size_t i = 0; i < slots && n < max; ++i)
+      {
+        size_t index = (start + i) % slots;
+        SessionSlot &slot = slots_[index];
+        if (slot.state.load(std::memory_order_acquire) == kFree)
+          continue;
+        Lane &lane = *slot.lanes[shard];
+        // Cancels still pending were queued first; they go next drain.
+        if (lane.cancels.size_approx() != 0)
+          continue;
+        size_t taken = 0;
+        if (lane.holding.load(std::memory_order_relaxed))
+        {
+          // Its position is lane.taken; the cancel it waited for may be
+          // parked on it now.
+          out[n] = lane.held;
+          lane.holding.store(false, std::memory_order_release);
+          ++taken;
+          if (!s.parked.empty() && !applyParked(s, shard, index, lane, out[n]))
+            ++removed;
+          else
+            ++n;
+        }
+        while (taken < quantum && n < max && lane.ring.try_pop(out[n]))
+        {
+          ++taken;
+          ++lane.taken;
+          if (!s.parked.empty() && !applyParked(s, shard, index, lane, out[n]))
+          {
+            ++removed;
+            continue;
+          }
+          if (lane.cancels.size_approx() != 0)
+          {
+            // A cancel was queued before this order; hold it back.
+            lane.held = out[n];
+            lane.holding.store(true, std::memory_order_release);
+            break;
+          }
+          ++n;
+        }
+        progress |= taken > 0;
+      }
+    }
+  }
+
+  // Parked cancels whose session has drained past them found their target
+  // in the book (or nowhere).
+  for (auto it = s.parked.begin(); it != s.parked.end();)
+  {
+    uint64_t passed = slots_[it->first.slot].lanes[shard]->passed();
+    for (ParkedCancel &p : it->second)
+      if (!p.laneDone && passed >= p.after)
+        settleParked(s, shard, p, false, false);
+    it = pruneParked(s, it);
+  }
+
+  if (n < max)
+    n += s.queue.try_dequeue_bulk(out + n, max - n);
+  if (n + removed > 0)
+    s.depth.fetch_sub(static_cast<int64_t>(n + removed), std::memory_order_relaxed);
+  return n;
+}
+
+bool ShardedEngine::applyParked(Shard &shard, size_t k, size_t slot, const Lane &lane, Order &o)
+{
+  auto it = shard.parked.find({slot, o.orderId});
+  if (it == shard.parked.end())
+    return true;
+
+  // Each cancel or replace queued after `o` applies in turn; once one has
+  // cancelled it, the rest find nothing.
+  bool keep = true;
+  bool caught = false;
+  for (ParkedCancel &p : it->second)
+  {
+    if (p.laneDone || lane.taken > p.after)
+      continue;
+    const Order &c = p.order;
+    bool applies = keep;
+    if (keep && c.type == OrderType::REPLACE && c.quantity > 0)
+    {
+      o.price = c.price;
+      o.quantity = c.quantity;
+    }
+    else
+    {
+      keep = false;
+    }
+    settleParked(shard, k, p, false, applies);
+    caught |= applies;
+  }
+  pruneParked(shard, it);
+  if (caught)
+    bump(shard.avoided, 1);
+  return keep;
+}
+
+void ShardedEngine::report(size_t shard, const Order &order, bool applied,
+                           const Trade *fills, size_t count)
+{
+  Shard &s = *shards_[shard];
+  if (order.type == OrderType::CANCEL || order.type == OrderType::REPLACE)
+  {
+    // Parked ones come back in the order they were drained.
+    auto it = s.parked.end();
+    ParkedCancel *parked = nullptr;
+    if (!s.parked.empty() && order.session != 0)
+      it = s.parked.find({slotOf(order.session), order.orderId});
+    if (it != s.parked.end())
+      for (ParkedCancel &p : it->second)
+        if (!p.engineDone)
+        {
+          parked = &p;
+          break;
+        }
+    if (parked)
+    {
+      settleParked(s, shard, *parked, true, applied);
+      pruneParked(s, it);
+    }
+    else
+    {
+      reportOutcome(s, shard, order, applied);
+    }
+  }
+  else
+  {
+    deliver(s, shard, order.session,
+            {order.orderId, 0, order.price, order.quantity, order.timestamp,
+             order.symbol, order.session, ExecType::Ack});
+  }
+
+  uint64_t filled = 0;
+  for (size_t i = 0; i < count; ++i)
+  {
+    const Trade &t = fills[i];
+    deliver(s, shard, t.buySession,
+            {t.buyOrderId, t.tradeId, t.price, t.quantity, t.timestamp,
+             t.symbol, t.buySession, ExecType::Fill});
+    deliver(s, shard, t.sellSession,
+            {t.sellOrderId, t.tradeId, t.price, t.quantity, t.timestamp,
+             t.symbol, t.sellSession, ExecType::Fill});
+    filled += t.quantity;
+  }
+
+  // A MARKET order's unfilled rest is dropped, not rested.
+  if (order.type == OrderType::MARKET && filled < order.quantity)
+    deliver(s, shard, order.session,
+            {order.orderId, 0, 0, order.quantity - filled, order.timestamp,
+             order.symbol, order.session, ExecType::Cancelled});
+}
+
+void ShardedEngine::flushReports(size_t shard)
+{
+  Shard &s = *shards_[shard];
+  for (size_t index : s.toWake)
+  {
+    s.waking[index] = 0;
+    SessionSlot &slot = slots_[index];
+    // Pairs with the re-arm in pollReports(): one of us sees the other.
+    if (slot.wakePending.exchange(true))
+      continue;
+    if (auto wake = std::atomic_load(&slot.wake))
+      (*wake)();
+  }
+  s.toWake.clear();
+}
+
+void ShardedEngine::deliver(Shard &s, size_t shard, uint32_t session, const ExecReport &r)
+{
+  if (session == 0)
+    return;
+  size_t index = slotOf(session);
+  if (index >= slotsInUse_.load(std::memory_order_acquire))
+    return;
+  SessionSlot &slot = slots_[index];
+  if (!slot.reporting.load(std::memory_order_acquire) ||
+      slot.session.load(std::memory_order_relaxed) != session)
+    return;
+
+  // Never wait on a session: a full ring loses the report.
+  if (!slot.lanes[shard]->reports.try_push(r))
+  {
+    slot.reportsDropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  if (!s.waking[index])
+  {
+    s.waking[index] = 1;
+    s.toWake.push_back(index);
+  }
+}
+
+void ShardedEngine::reportOutcome(Shard &s, size_t shard, const Order &c, bool applied)
+{
+  ExecType type = ExecType::Rejected;
+  if (applied)
+    type = c.type == OrderType::REPLACE && c.quantity > 0 ? ExecType::Replaced
+                                                           : ExecType::Cancelled;
+  deliver(s, shard, c.session,
+          {c.orderId, 0, c.price, c.quantity, c.timestamp, c.symbol, c.session, type});
+}
+
+void ShardedEngine::settleParked(Shard &s, size_t shard, ParkedCancel &p, bool byEngine,
+                                 bool applied)
+{
+  (byEngine ? p.engineDone : p.laneDone) = true;
+  if (applied && !p.reported)
+  {
+    reportOutcome(s, shard, p.order, true);
+    p.reported = true;
+  }
+  if (p.engineDone && p.laneDone && !p.reported)
+  {
+    reportOutcome(s, shard, p.order, false);
+    p.reported = true;
+  }
+}
+
+ShardedEngine::ParkedMap::iterator ShardedEngine::pruneParked(Shard &s, ParkedMap::iterator it)
+{
+  auto &list = it->second;
+  list.erase(std::remove_if(list.begin(), list.end(), [](const ParkedCancel &p)
+                            { return p.laneDone && p.engineDone; }),
+             list.end());
+  if (list.empty())
+    return s.parked.erase(it);
+  return std::next(it);
+}
+
+bool ShardedEngine::hasInput(size_t shard) const
+{
+  if (shards_[shard]->queue.size_approx() != 0)
+    return true;
+  if (shards_[shard]->ring)
+    return shards_[shard]->ring->available();
+  size_t slots = slotsInUse_.load(std::memory_order_acquire);
+  for (size_t i = 0; i < slots; ++i)
+  {
+    const SessionSlot &slot = slots_[i];
+    if (slot.state.load(std::memory_order_acquire) != kFree &&
+        !slot.lanes[shard]->empty())
+      return true;
+  }
+  return false;
+}
+
+std::vector<SessionStats> ShardedEngine::sessionStats(size_t shard) const
+{
+  std::vector<SessionStats> out;
+  size_t slots = slotsInUse_.load(std::memory_order_acquire);
+  for (size_t i = 0; i < slots; ++i)
+  {
+    const SessionSlot &slot = slots_[i];
+    uint32_t state = slot.state.load(std::memory_order_acquire);
+    const Lane &lane = *slot.lanes[shard];
+    uint64_t depth = lane.ring.size_approx() + lane.cancels.size_approx() +
+                     lane.holding.load(std::memory_order_acquire);
+    if (state == kFree || (state == kClosed && depth == 0))
+      continue;
+    out.push_back({slot.session.load(std::memory_order_relaxed),
+                   lane.enqueued.load(std::memory_order_relaxed) -
+                       slot.enqueuedAtOpen[shard].load(std::memory_order_relaxed),
+                   depth});
+  }
+  return out;
+}
+
+PriorityStats ShardedEngine::priorityStats(size_t shard) const
+{
+  const Shard &s = *shards_[shard];
+  return {s.cancelsAhead.load(std::memory_order_relaxed),
+          s.overtaken.load(std::memory_order_relaxed),
+          s.avoided.load(std::memory_order_relaxed)};
+}
+
+uint64_t ShardedEngine::depth(size_t shard) const
+{
+  int64_t d = shards_[shard]->depth.load(std::memory_order_relaxed);
+  return d > 0 ? static_cast<uint64_t>(d) : 0;
+}
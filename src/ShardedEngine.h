@@ -0,0 +1,389 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <concurrentqueue.h>
+#include "ExecReport.h"
+#include "MatchingEngine.h"
+#include "Order.h"
+#include "SequencedRing.h"
+#include "SpscRing.h"
+#include "SymbolDirectory.h"
+#include "WaitStrategy.h"
+
+// How sessions hand orders to a shard.
+//   Lanes - one SPSC lane per session per shard, drained round-robin.
+//   Ring  - all sessions claim slots in one preallocated sequenced ring per
+//           shard (SequencedRing); strict arrival order, no per-session
+//           fairness or depth.
+enum class IngressMode { Lanes, Ring };
+
+// "ring" or "lanes"; anything else is Lanes.
+IngressMode parseIngressMode(const std::string &name);
+
+// What happens to a new order while its shard has IngressConfig::highWater
+// or more orders queued. Cancels and replaces are admitted either way.
+//   Backpressure - the submitting thread waits for the shard to drain below
+//                  the mark; a session thread stops reading its socket, so
+//                  the client sees TCP flow control.
+//   Reject       - the order is refused with RejectReason::Overloaded.
+enum class OverloadPolicy { Backpressure, Reject };
+
+// "reject" or "backpressure"; anything else is Backpressure.
+OverloadPolicy parseOverloadPolicy(const std::string &name);
+
+enum class RejectReason : uint8_t { None, Overloaded };
+
+// "OVERLOADED" etc., as sent back to clients.
+const char *rejectReasonName(RejectReason reason);
+
+struct IngressConfig
+{
+  IngressMode mode = IngressMode::Lanes;
+  size_t maxSessions = 256;      // concurrently open sessions
+  size_t laneCapacity = 4096;    // Lanes: orders buffered per session per shard
+  size_t quantum = 16;           // Lanes: orders taken from one session per pass
+  size_t cancelCapacity = 1024;  // Lanes: cancels/replaces buffered per session per shard
+  size_t ringCapacity = 1u << 16; // Ring: slots per shard
+  size_t highWater = 0;           // queued orders per shard; 0 = no limit
+  OverloadPolicy overload = OverloadPolicy::Backpressure;
+  size_t reportCapacity = 4096;   // execution reports buffered per session per shard
+};
+
+// Counters for one session's lane into one shard.
+struct SessionStats
+{
+  uint32_t session;
+  uint64_t accepted; // orders enqueued since the session opened
+  uint64_t depth;    // of those, still waiting for the engine
+};
+
+// Cancels and replaces that took a session's priority lane into one shard.
+struct PriorityStats
+{
+  uint64_t cancels;   // drained ahead of orders their session queued earlier
+  uint64_t overtaken; // queued orders those cancels jumped
+  uint64_t avoided;   // queued orders cancelled or re-priced before matching
+};
+
+// N independent matching shards over one SymbolDirectory. Every symbol
+// belongs to exactly one shard, and each shard has its own input queue and
+// MatchingEngine drained by a single thread, so one symbol's orders are
+// still matched in arrival order while different symbols run in parallel.
+//
+// Client connections open a Session, which owns a private SPSC lane into
+// every shard. Shard threads drain the lanes round-robin, a quantum at a
+// time, so a flooding client fills (and then waits on) its own lane rather
+// than queueing ahead of everyone else. A session's cancels and replaces
+// take a separate priority lane that is drained before any new orders; one
+// that overtakes the session's own queued orders is also parked, and applied
+// to its target if that target is still in the lane. submit() feeds a
+// shared MPMC queue per shard for callers without a session.
+//
+// Sessions that ask for them get execution reports back (see ExecReport):
+// shard threads queue them on a per-session SPSC ring per shard and wake
+// the session once per batch, never waiting on it. A session that lets its
+// rings fill loses reports (counted by reportsDropped()), not the engine
+// time.
+class ShardedEngine
+{
+public:
+  using Queue = moodycamel::ConcurrentQueue<Order>;
+
+  explicit ShardedEngine(size_t shards,
+                         std::shared_ptr<SymbolDirectory> symbols =
+                             std::make_shared<SymbolDirectory>(),
+                         const PoolConfig &pools = {},
+                         WaitMode wait = WaitMode::Block,
+                         const IngressConfig &ingress = {});
+
+  // One client's ingress path. Only one thread at a time may submit (calls
+  // from different threads must be ordered, as consecutive handlers of one
+  // connection are); destroying it frees the slot once the shards have
+  // drained its lanes.
+  class Session
+  {
+  public:
+    ~Session();
+    Session(const Session &) = delete;
+    Session &operator=(const Session &) = delete;
+
+    uint32_t id() const { return id_; }
+    // Enqueue on the owning shard's lane (or ring), waiting while full.
+    // Above the high-water mark, waits or rejects per OverloadPolicy.
+    RejectReason submit(const Order &order);
+    // Never waits: false if the order would have to (lane or ring full, or
+    // over the high-water mark under Backpressure), so the caller can retry
+    // later. True if it was queued or, with `reason` set, rejected.
+    bool trySubmit(const Order &order, RejectReason &reason);
+
+    // Have reports for this session's orders queued for it; call before
+    // submitting. `wake` runs on a shard thread whenever reports arrive
+    // while none were pending: it should schedule pollReports() on the
+    // session's own thread and return.
+    void onReports(std::function<void()> wake);
+    // Session thread: hand every queued report to f(const ExecReport &),
+    // oldest first per shard, and re-arm `wake`. Returns the count.
+    template <class F>
+    size_t pollReports(F &&f);
+    // Reports lost because this session's rings were full. Any thread.
+    uint64_t reportsDropped() const;
+
+  private:
+    friend class ShardedEngine;
+    Session(ShardedEngine &engines, size_t slot, uint32_t id)
+        : engines_(engines), slot_(slot), id_(id) {}
+
+    // Shared by submit() and trySubmit(): true once queued.
+    bool enqueue(const Order &submitted, bool wait, RejectReason &reason);
+
+    ShardedEngine &engines_;
+    size_t slot_;
+    uint32_t id_;
+  };
+
+  // nullptr once IngressConfig::maxSessions sessions are open.
+  std::unique_ptr<Session> openSession();
+
+  size_t size() const { return shards_.size(); }
+
+  // Owning shard: SymbolSpec::shard if pinned, else a hash of the name.
+  // Safe to call from any thread.
+  size_t shardOf(SymbolId symbol) const;
+
+  // Enqueue on the owning shard's input queue and wake its thread. False
+  // if the order was rejected for overload.
+  bool submit(const Order &order)
+  {
+    Shard &shard = *shards_[shardOf(order.symbol)];
+    RejectReason reason;
+    if (!admit(shard, order, true, reason))
+      return false;
+    shard.depth.fetch_add(1, std::memory_order_relaxed);
+    bool ok = shard.queue.enqueue(order);
+    shard.wait.notify();
+    return ok;
+  }
+
+  // Shard thread only: take up to `max` orders from the shard's session
+  // lanes (round-robin) or ring, and its shared queue, into `out`.
+  size_t drain(size_t shard, Order *out, size_t max);
+  // Whether `shard` has anything to drain; safe from the shard thread's
+  // wait predicate.
+  bool hasInput(size_t shard) const;
+
+  // Shard thread, after MatchingEngine::onNewOrder() took `order` (drained
+  // from `shard`) and returned `applied` and `fills`: queue the reports for
+  // every session involved, the resting side's included.
+  void report(size_t shard, const Order &order, bool applied,
+              const Trade *fills, size_t count);
+  // Shard thread, once per batch: wake the sessions reported to since the
+  // last call.
+  void flushReports(size_t shard);
+
+  // Open (and still draining) sessions' lanes into `shard`. Any thread.
+  std::vector<SessionStats> sessionStats(size_t shard) const;
+
+  // Orders submitted to `shard` and not yet drained, across all inputs.
+  uint64_t depth(size_t shard) const;
+  // Priority-lane counters for `shard` since startup. Any thread.
+  PriorityStats priorityStats(size_t shard) const;
+
+  // Orders refused by `shard` for overload since startup.
+  uint64_t rejected(size_t shard) const
+  {
+    return shards_[shard]->rejected.load(std::memory_order_relaxed);
+  }
+
+  Queue &queue(size_t shard) { return shards_[shard]->queue; }
+  WaitStrategy &waiter(size_t shard) { return shards_[shard]->wait; }
+  MatchingEngine &engine(size_t shard) { return shards_[shard]->engine; }
+  MatchingEngine &engineFor(SymbolId symbol) { return engine(shardOf(symbol)); }
+
+  SymbolDirectory &symbols() const { return *symbols_; }
+
+  // Per-symbol depth/trade views, published by each shard's thread and safe
+  // to read from any other (see MatchingEngine::publishViews).
+  MarketViews &views() { return views_; }
+
+private:
+  // Lets tests set up lane states that otherwise take a racing submitter.
+  friend struct ShardedEngineTestAccess;
+
+  // A cancel or replace that was drained ahead of ordinary orders its
+  // session had queued before it (positions up to `after` in its lane).
+  // The lane and the engine each say whether it found its target (still
+  // queued, or in the book); once both have, the outcome is reported and
+  // the entry dropped.
+  struct ParkedCancel
+  {
+    uint64_t after;
+    Order order;
+    bool laneDone = false;
+    bool engineDone = false;
+    bool reported = false;
+  };
+
+  // Order ids are only unique within a session.
+  struct ParkedKey
+  {
+    size_t slot;
+    uint64_t orderId;
+    bool operator==(const ParkedKey &o) const { return slot == o.slot && orderId == o.orderId; }
+  };
+  struct ParkedKeyHash
+  {
+    size_t operator()(const ParkedKey &k) const
+    {
+      return std::hash<uint64_t>{}(k.orderId ^ (static_cast<uint64_t>(k.slot) << 48));
+    }
+  };
+  // Every cancel parked on one target, in queue order.
+  using ParkedMap = std::unordered_map<ParkedKey, std::vector<ParkedCancel>, ParkedKeyHash>;
+
+  struct Shard
+  {
+    Shard(std::shared_ptr<SymbolDirectory> symbols, const PoolConfig &pools,
+          WaitMode wait)
+        : engine(std::move(symbols), pools), wait(wait) {}
+
+    Queue queue;
+    MatchingEngine engine;
+    WaitStrategy wait; // how the shard's thread idles on an empty queue
+    size_t cursor = 0; // round-robin start, shard thread only
+    std::unique_ptr<SequencedRing<Order>> ring; // IngressMode::Ring only
+    ParkedMap parked; // shard thread only
+    std::atomic<uint64_t> cancelsAhead{0}; // written by the shard thread only
+    std::atomic<uint64_t> overtaken{0};
+    std::atomic<uint64_t> avoided{0};
+    std::vector<uint8_t> waking; // by slot: in toWake
+    std::vector<size_t> toWake;  // slots reported to this batch
+
+    // Raised by submitters before they enqueue, lowered by drain(); may
+    // dip below zero briefly. Own line: every submitter touches it.
+    alignas(64) std::atomic<int64_t> depth{0};
+    std::atomic<uint64_t> rejected{0};
+  };
+
+  // A cancel or replace with the number of the session's ordinary orders
+  // queued on the same shard before it.
+  struct QueuedCancel
+  {
+    Order order;
+    uint64_t after;
+  };
+
+  struct Lane
+  {
+    Lane(size_t capacity, size_t cancelCapacity, size_t reportCapacity)
+        : ring(capacity), cancels(cancelCapacity), reports(reportCapacity) {}
+
+    bool empty() const
+    {
+      return ring.size_approx() == 0 && cancels.size_approx() == 0 &&
+             !holding.load(std::memory_order_acquire);
+    }
+
+    SpscRing<Order> ring;
+    SpscRing<QueuedCancel> cancels;    // Lanes mode: CANCEL and REPLACE
+    std::atomic<uint64_t> enqueued{0}; // written by the session thread only
+    uint64_t pushed = 0;               // into `ring`, session thread only
+
+    // Shard thread only (`holding` is read elsewhere for depth). An order
+    // popped while a cancel queued before it was still pending waits in
+    // `held` until that cancel has gone first.
+    alignas(64) uint64_t taken = 0; // out of `ring`
+    std::atomic<bool> holding{false};
+    Order held;
+
+    // Ordinary orders passed on (or dropped) so far: a held order has been
+    // taken but a cancel can still catch it. Shard thread only.
+    uint64_t passed() const { return taken - holding.load(std::memory_order_relaxed); }
+
+    // Shard thread → session owner.
+    SpscRing<ExecReport> reports;
+  };
+
+  enum SlotState : uint32_t { kFree, kOpen, kClosed };
+
+  // Session slots are created on demand and then reused, never freed, so
+  // shard threads and stats readers can hold on to their lanes safely.
+  struct SessionSlot
+  {
+    std::atomic<uint32_t> state{kFree};
+    std::atomic<uint32_t> session{0};
+    std::unique_ptr<std::atomic<uint64_t>[]> enqueuedAtOpen; // per shard
+    std::vector<std::unique_ptr<Lane>> lanes;                // one per shard
+
+    // Reports: wanted at all, a wake already outstanding, and the callback
+    // (swapped with std::atomic_load/store while shards may be calling it).
+    std::atomic<bool> reporting{false};
+    std::atomic<bool> wakePending{false};
+    std::shared_ptr<const std::function<void()>> wake;
+    std::atomic<uint64_t> reportsDropped{0};
+  };
+
+  static constexpr uint32_t kUnrouted = ~uint32_t{0};
+
+  // Whether the high-water mark applies to `order` right now.
+  bool overloaded(const Shard &shard, const Order &order) const;
+  // Apply the high-water mark to one order bound for `shard`: true if it may
+  // be queued. Rejections set `reason`; under Backpressure this waits for
+  // the shard to drain, or returns false at once if `wait` is false. Racing
+  // submitters can each pass just below the mark, so it is soft by at most
+  // one order per submitting thread.
+  bool admit(Shard &shard, const Order &order, bool wait, RejectReason &reason);
+
+  // Apply a parked cancel or replace to ordinary order `o`, just taken from
+  // lane `slot` into shard `k`. False if the order was cancelled and must be
+  // dropped.
+  bool applyParked(Shard &shard, size_t k, size_t slot, const Lane &lane, Order &o);
+
+  // Queue `r` for `session` (0: none) and mark it for waking.
+  void deliver(Shard &s, size_t shard, uint32_t session, const ExecReport &r);
+  // Report a cancel or replace as applied, or as Rejected.
+  void reportOutcome(Shard &s, size_t shard, const Order &c, bool applied);
+  // One side's verdict on `p`; reports once it is final.
+  void settleParked(Shard &s, size_t shard, ParkedCancel &p, bool byEngine, bool applied);
+  // Drop the entries under `it` that both sides have settled; returns the
+  // next position.
+  ParkedMap::iterator pruneParked(Shard &s, ParkedMap::iterator it);
+
+  size_t slotOf(uint32_t session) const { return (session - 1) % ingress_.maxSessions; }
+
+  IngressConfig ingress_;
+  std::unique_ptr<SessionSlot[]> slots_;
+  std::atomic<size_t> slotsInUse_{0}; // slots ever handed out
+  std::mutex sessionsMutex_;          // serialises open/reuse
+  uint32_t nextSession_ = 0; // generations; ids also encode the slot
+
+  std::shared_ptr<SymbolDirectory> symbols_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+  MarketViews views_;
+  // SymbolId → shard, filled in on first use so names are hashed once.
+  std::unique_ptr<std::atomic<uint32_t>[]> routes_;
+};
+
+template <class F>
+size_t ShardedEngine::Session::pollReports(F &&f)
+{
+  SessionSlot &slot = engines_.slots_[slot_];
+  // Re-arm first: anything pushed from here on wakes us again.
+  slot.wakePending.store(false);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  size_t n = 0;
+  ExecReport r;
+  for (auto &lane : slot.lanes)
+    while (lane->reports.try_pop(r))
+    {
+      // Left over from the slot's previous session.
+      if (r.session != id_)
+        continue;
+      f(r);
+      ++n;
+    }
+  return n;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Bounded single-producer/single-consumer ring. Slots are preallocated, so
+// push/pop never allocate; each side only touches the other's index when
+// its cached copy says the ring looks full (producer) or empty (consumer).
+template <class T>
+class SpscRing
+{
+public:
+  // Capacity is rounded up to a power of two.
+  explicit SpscRing(size_t capacity)
+  {
+    size_t n = 2;
+    while (n < capacity)
+      n <<= 1;
+    slots_.resize(n);
+    mask_ = n - 1;
+  }
+
+  SpscRing(const SpscRing &) = delete;
+  SpscRing &operator=(const SpscRing &) = delete;
+
+  size_t capacity() const { return slots_.size(); }
+
+  size_t size_approx() const
+  {
+    return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+  }
+
+  // Producer only.
+  bool try_push(const T &v)
+  {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head - cachedTail_ == slots_.size())
+    {
+      cachedTail_ = tail_.load(std::memory_order_acquire);
+      if (head - cachedTail_ == slots_.size())
+        return false;
+    }
+    slots_[head & mask_] = v;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only.
+  bool try_pop(T &out)
+  {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == cachedHead_)
+    {
+      cachedHead_ = head_.load(std::memory_order_acquire);
+      if (tail == cachedHead_)
+        return false;
+    }
+    out = slots_[tail & mask_];
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+private:
+  std::vector<T> slots_;
+  size_t mask_;
+
+  // Producer and consumer state on separate cache lines.
+  alignas(64) std::atomic<size_t> head_{0}; // next slot to write
+  size_t cachedTail_ = 0;
+  alignas(64) std::atomic<size_t> tail_{0}; // next slot to read
+  size_t cachedHead_ = 0;
+};
@@ -0,0 +1,104 @@
+#include "SymbolDirectory.h"
+#include <mutex>
+#include <sstream>
+
+SymbolDirectory::SymbolDirectory(double defaultTickSize, size_t capacity)
+    : defaults_{defaultTickSize, BookType::Map, LadderConfig{}, -1},
+      capacity_(capacity),
+      entries_(new Entry[capacity])
+{
+  ids_.reserve(capacity);
+}
+
+SymbolId SymbolDirectory::find(std::string_view name) const
+{
+  std::shared_lock lock(mutex_);
+  auto it = ids_.find(std::string(name));
+  return it == ids_.end() ? kInvalid : it->second;
+}
+
+SymbolId SymbolDirectory::intern(std::string_view name)
+{
+  SymbolId id = find(name);
+  if (id != kInvalid)
+    return id;
+
+  std::unique_lock lock(mutex_);
+  auto it = ids_.find(std::string(name));
+  if (it != ids_.end())
+    return it->second;
+
+  size_t n = size_.load(std::memory_order_relaxed);
+  if (n == capacity_)
+    return kInvalid;
+  entries_[n] = Entry{std::string(name), defaults_};
+  ids_.emplace(std::string(name), static_cast<SymbolId>(n));
+  size_.store(n + 1, std::memory_order_release);
+  return static_cast<SymbolId>(n);
+}
+
+void SymbolDirectory::setTickSize(std::string_view symbol, double tickSize)
+{
+  SymbolId id = intern(symbol);
+  if (id != kInvalid)
+    entries_[id].spec.tickSize = tickSize;
+}
+
+void SymbolDirectory::setBookType(std::string_view symbol, BookType book,
+                                  const LadderConfig &ladder)
+{
+  SymbolId id = intern(symbol);
+  if (id == kInvalid)
+    return;
+  entries_[id].spec.book = book;
+  entries_[id].spec.ladder = ladder;
+}
+
+void SymbolDirectory::setShard(std::string_view symbol, int shard)
+{
+  SymbolId id = intern(symbol);
+  if (id != kInvalid)
+    entries_[id].spec.shard = shard;
+}
+
+void SymbolDirectory::loadTickSizes(const std::string &spec)
+{
+  std::istringstream ss(spec);
+  std::string entry;
+  while (std::getline(ss, entry, ','))
+  {
+    auto colon = entry.find(':');
+    if (colon == std::string::npos)
+      continue;
+    setTickSize(entry.substr(0, colon), std::stod(entry.substr(colon + 1)));
+  }
+}
+
+void SymbolDirectory::loadArrayBooks(const std::string &spec)
+{
+  std::istringstream ss(spec);
+  std::string entry;
+  while (std::getline(ss, entry, ','))
+  {
+    if (entry.empty())
+      continue;
+    LadderConfig ladder;
+    auto colon = entry.find(':');
+    if (colon != std::string::npos)
+      ladder.ticks = std::stoul(entry.substr(colon + 1));
+    setBookType(entry.substr(0, colon), BookType::Array, ladder);
+  }
+}
+
+void SymbolDirectory::loadShards(const std::string &spec)
+{
+  std::istringstream ss(spec);
+  std::string entry;
+  while (std::getline(ss, entry, ','))
+  {
+    auto colon = entry.find(':');
+    if (colon == std::string::npos)
+      continue;
+    setShard(entry.substr(0, colon), std::stoi(entry.substr(colon + 1)));
+  }
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "Order.h"
+#include "PriceLadder.h"
+
+enum class BookType { Map, Array };
+
+// Per-symbol reference data.
+struct SymbolSpec
+{
+  double tickSize;
+  BookType book = BookType::Map;
+  LadderConfig ladder;
+  int shard = -1; // engine shard pinned by config; -1 routes by name hash
+};
+
+// Interns symbol names into dense SymbolIds at ingest so the rest of the
+// system (orders, trades, book registry) never hashes or copies strings.
+// intern()/find()/name()/spec() are safe to call from any thread; the
+// set*/load* configuration calls are meant for startup only.
+class SymbolDirectory
+{
+public:
+  static constexpr SymbolId kInvalid = ~SymbolId{0};
+
+  explicit SymbolDirectory(double defaultTickSize = 0.01, size_t capacity = 4096);
+
+  // Id for `name`, registering it on first sight. kInvalid once full.
+  SymbolId intern(std::string_view name);
+  // Id for `name` if already known, else kInvalid.
+  SymbolId find(std::string_view name) const;
+
+  const std::string &name(SymbolId id) const { return entries_[id].name; }
+  const SymbolSpec &spec(SymbolId id) const { return entries_[id].spec; }
+  double tickSize(SymbolId id) const { return entries_[id].spec.tickSize; }
+  size_t size() const { return size_.load(std::memory_order_acquire); }
+  size_t capacity() const { return capacity_; }
+
+  void setTickSize(std::string_view symbol, double tickSize);
+  void setBookType(std::string_view symbol, BookType book,
+                   const LadderConfig &ladder = {});
+  void setShard(std::string_view symbol, int shard);
+
+  // Parse "AAPL:0.01,BRK.A:1" style overrides (e.g. from $TICK_SIZES).
+  void loadTickSizes(const std::string &spec);
+  // Parse "AAPL,MSFT:8192" (symbol[:window ticks]) to use array books.
+  void loadArrayBooks(const std::string &spec);
+  // Parse "AAPL:0,MSFT:1" symbol-to-shard pins (e.g. from $SHARD_MAP).
+  void loadShards(const std::string &spec);
+
+private:
+  struct Entry
+  {
+    std::string name;
+    SymbolSpec spec;
+  };
+
+  SymbolSpec defaults_;
+  size_t capacity_;
+  std::unique_ptr<Entry[]> entries_; // fixed capacity: never reallocated
+  std::atomic<size_t> size_{0};
+  mutable std::shared_mutex mutex_;
+  std::unordered_map<std::string, SymbolId> ids_;
+};
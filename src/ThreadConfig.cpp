@@ -0,0 +1,194 @@
+#include "ThreadConfig.h"
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string_view>
+#include <thread>
+#include <pthread.h>
+#ifdef __linux__
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+  const char *kEnvSuffix[] = {"ENGINE", "PUBLISHER", "INGEST", "HTTP"};
+
+  std::string cpuListString(const std::vector<int> &cpus)
+  {
+    std::string out;
+    for (int c : cpus)
+      out += (out.empty() ? "" : ",") + std::to_string(c);
+    return out;
+  }
+
+  // The whole of `text` as a CPU number.
+  bool parseCpu(std::string_view text, int &cpu)
+  {
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), cpu);
+    return ec == std::errc() && end == text.data() + text.size() && cpu >= 0;
+  }
+
+  void logCpuEntry(const std::string &spec, std::string_view entry, const std::string &what)
+  {
+    std::cerr << "CPU list \"" << spec << "\": " << what << " \"" << entry << "\"\n";
+  }
+}
+
+const char *threadRoleName(ThreadRole role)
+{
+  switch (role)
+  {
+  case ThreadRole::Engine:
+    return "engine";
+  case ThreadRole::Publisher:
+    return "publisher";
+  case ThreadRole::Ingest:
+    return "ingest";
+  case ThreadRole::Http:
+    break;
+  }
+  return "http";
+}
+
+int configuredCpuCount()
+{
+#ifdef __linux__
+  long n = sysconf(_SC_NPROCESSORS_CONF);
+  return n > 0 ? static_cast<int>(std::min<long>(n, CPU_SETSIZE)) : 1;
+#else
+  return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+#endif
+}
+
+std::vector<int> parseCpuList(const std::string &spec, int cpuCount)
+{
+  std::vector<int> cpus;
+  std::string_view rest(spec);
+  while (!rest.empty())
+  {
+    size_t comma = rest.find(',');
+    std::string_view entry = rest.substr(0, comma);
+    rest = comma == std::string_view::npos ? std::string_view() : rest.substr(comma + 1);
+    if (entry.empty())
+      continue;
+
+    auto dash = entry.find('-');
+    int lo = 0;
+    int hi = 0;
+    if (!parseCpu(entry.substr(0, dash), lo) ||
+        (dash != std::string_view::npos && !parseCpu(entry.substr(dash + 1), hi)))
+    {
+      logCpuEntry(spec, entry, "ignoring malformed entry");
+      continue;
+    }
+    if (dash == std::string_view::npos)
+      hi = lo;
+    if (hi < lo || lo >= cpuCount)
+    {
+      logCpuEntry(spec, entry, hi < lo ? "ignoring reversed range" : "ignoring unconfigured cpu");
+      continue;
+    }
+    if (hi >= cpuCount)
+    {
+      logCpuEntry(spec, entry, "only " + std::to_string(cpuCount) + " cpus configured, cutting");
+      hi = cpuCount - 1;
+    }
+    for (int c = lo; c <= hi; ++c)
+      cpus.push_back(c);
+  }
+  return cpus;
+}
+
+ThreadConfig ThreadConfig::fromEnv()
+{
+  ThreadConfig cfg;
+  for (int r = 0; r < 4; ++r)
+  {
+    std::string suffix = kEnvSuffix[r];
+    if (const char *cpus = std::getenv(("CPU_" + suffix).c_str()))
+      cfg.roles_[r].cpus = parseCpuList(cpus);
+    if (const char *prio = std::getenv(("RT_" + suffix).c_str()))
+      cfg.roles_[r].rtPriority = std::atoi(prio);
+  }
+  return cfg;
+}
+
+std::vector<int> ThreadConfig::cpusFor(ThreadRole r, size_t index) const
+{
+  const auto &cpus = role(r).cpus;
+  if (cpus.empty())
+    return {};
+  if (r == ThreadRole::Engine || r == ThreadRole::Publisher)
+    return {cpus[index % cpus.size()]};
+  return cpus;
+}
+
+bool ThreadConfig::apply(ThreadRole r, size_t index) const
+{
+  bool ok = true;
+  std::string name = std::string(threadRoleName(r)) + "-" + std::to_string(index);
+  name.resize(std::min<size_t>(name.size(), 15)); // kernel limit
+
+#ifdef __linux__
+  pthread_setname_np(pthread_self(), name.c_str());
+
+  auto cpus = cpusFor(r, index);
+  if (!cpus.empty())
+  {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int c : cpus)
+      CPU_SET(c, &set);
+    if (int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set))
+    {
+      std::cerr << name << ": cannot pin to cpus " << cpuListString(cpus)
+                << ": " << std::strerror(err) << "\n";
+      ok = false;
+    }
+  }
+
+  if (int prio = role(r).rtPriority; prio > 0)
+  {
+    sched_param param{};
+    param.sched_priority = prio;
+    if (int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param))
+    {
+      std::cerr << name << ": cannot use SCHED_FIFO " << prio
+                << ": " << std::strerror(err) << "\n";
+      ok = false;
+    }
+  }
+#elif defined(__APPLE__)
+  pthread_setname_np(name.c_str());
+#endif
+  return ok;
+}
+
+std::string ThreadConfig::describe(size_t shards) const
+{
+  std::ostringstream out;
+  for (int i = 0; i < 4; ++i)
+  {
+    auto r = static_cast<ThreadRole>(i);
+    bool perShard = r == ThreadRole::Engine || r == ThreadRole::Publisher;
+    out << "  " << threadRoleName(r) << ": ";
+    if (roles_[i].cpus.empty())
+      out << "unpinned";
+    else if (perShard)
+      for (size_t k = 0; k < shards; ++k)
+        out << (k ? ", " : "") << "shard " << k << " on cpu " << cpusFor(r, k)[0];
+    else
+      out << "cpus " << cpuListString(roles_[i].cpus);
+    if (roles_[i].rtPriority > 0)
+      out << ", SCHED_FIFO " << roles_[i].rtPriority;
+    out << "\n";
+  }
+#ifndef __linux__
+  out << "  (affinity and SCHED_FIFO need Linux; only thread names applied)\n";
+#endif
+  return out.str();
+}
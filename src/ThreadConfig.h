@@ -0,0 +1,52 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// Thread roles that can be placed independently.
+enum class ThreadRole { Engine, Publisher, Ingest, Http };
+
+const char *threadRoleName(ThreadRole role);
+
+// Where and how one role's threads run.
+struct RolePlacement
+{
+  std::vector<int> cpus; // empty: leave to the OS scheduler
+  int rtPriority = 0;    // > 0: SCHED_FIFO at this priority
+};
+
+// Per-role CPU sets, thread names and scheduling class. Engine and
+// publisher threads are per shard: shard k is pinned to the single CPU
+// cpus[k % cpus.size()], so each shard keeps its core (and cache) to
+// itself. Ingest and HTTP threads float over their whole set.
+//
+// Affinity and SCHED_FIFO are Linux-only; elsewhere only names are set.
+class ThreadConfig
+{
+public:
+  // CPU_ENGINE, CPU_PUBLISHER, CPU_INGEST, CPU_HTTP take CPU lists such as
+  // "2,3" or "4-7"; RT_ENGINE, RT_PUBLISHER, ... take a SCHED_FIFO priority.
+  static ThreadConfig fromEnv();
+
+  RolePlacement &role(ThreadRole r) { return roles_[static_cast<int>(r)]; }
+  const RolePlacement &role(ThreadRole r) const { return roles_[static_cast<int>(r)]; }
+
+  // Name, pin and schedule the calling thread as instance `index` of
+  // `role`. Returns false (after logging why) if any step was refused.
+  bool apply(ThreadRole role, size_t index = 0) const;
+
+  // One line per role, for the startup log.
+  std::string describe(size_t shards) const;
+
+private:
+  RolePlacement roles_[4];
+
+  std::vector<int> cpusFor(ThreadRole role, size_t index) const;
+};
+
+// CPUs the system is configured with (online or not), at most CPU_SETSIZE.
+int configuredCpuCount();
+
+// Parse "0,2,4-7" into {0,2,4,5,6,7}. Entries that are malformed or name
+// no CPU below `cpuCount` are skipped, and ranges cut at cpuCount - 1; each
+// is logged.
+std::vector<int> parseCpuList(const std::string &spec, int cpuCount = configuredCpuCount());
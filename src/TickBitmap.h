@@ -0,0 +1,116 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Hierarchical occupancy bitmap over a tick range. Level 0 has one bit per
+// tick; each level above has one bit per non-zero word of the level below,
+// up to a single top word. Finding the next/previous occupied tick is a
+// find-first-set per level (three levels cover 262144 ticks), so sweeps over
+// empty ticks cost the same on gappy books as on dense ones.
+class TickBitmap
+{
+public:
+  static constexpr size_t npos = ~size_t{0};
+
+  explicit TickBitmap(size_t bits = 0) { resize(bits); }
+
+  // Resize to `bits` ticks, all clear.
+  void resize(size_t bits)
+  {
+    size_ = bits;
+    levels_.clear();
+    size_t n = bits;
+    do
+    {
+      n = n > 64 ? (n + 63) / 64 : 1;
+      levels_.emplace_back(n, 0);
+    } while (n > 1);
+  }
+
+  size_t size() const { return size_; }
+  bool any() const { return levels_.back()[0] != 0; }
+
+  bool test(size_t i) const { return (levels_[0][i >> 6] >> (i & 63)) & 1; }
+
+  void set(size_t i)
+  {
+    for (auto &level : levels_)
+    {
+      uint64_t &word = level[i >> 6];
+      bool wasEmpty = word == 0;
+      word |= uint64_t{1} << (i & 63);
+      if (!wasEmpty)
+        return;
+      i >>= 6;
+    }
+  }
+
+  void clear(size_t i)
+  {
+    for (auto &level : levels_)
+    {
+      uint64_t &word = level[i >> 6];
+      word &= ~(uint64_t{1} << (i & 63));
+      if (word != 0)
+        return;
+      i >>= 6;
+    }
+  }
+
+  // Smallest set index >= i, or npos.
+  size_t findNext(size_t i) const
+  {
+    if (i >= size_)
+      return npos;
+    size_t l = 0;
+    for (;;)
+    {
+      size_t w = i >> 6;
+      uint64_t bits = levels_[l][w] & (~uint64_t{0} << (i & 63));
+      if (bits)
+      {
+        i = (w << 6) | static_cast<size_t>(__builtin_ctzll(bits));
+        break;
+      }
+      if (l + 1 == levels_.size() || w + 1 >= levels_[l].size())
+        return npos;
+      i = w + 1;
+      ++l;
+    }
+    while (l-- > 0)
+      i = (i << 6) | static_cast<size_t>(__builtin_ctzll(levels_[l][i]));
+    return i;
+  }
+
+  // Largest set index <= i, or npos.
+  size_t findPrev(size_t i) const
+  {
+    if (i == npos || size_ == 0)
+      return npos;
+    if (i >= size_)
+      i = size_ - 1;
+    size_t l = 0;
+    for (;;)
+    {
+      size_t w = i >> 6;
+      uint64_t bits = levels_[l][w] & (~uint64_t{0} >> (63 - (i & 63)));
+      if (bits)
+      {
+        i = (w << 6) | static_cast<size_t>(63 - __builtin_clzll(bits));
+        break;
+      }
+      if (l + 1 == levels_.size() || w == 0)
+        return npos;
+      i = w - 1;
+      ++l;
+    }
+    while (l-- > 0)
+      i = (i << 6) | static_cast<size_t>(63 - __builtin_clzll(levels_[l][i]));
+    return i;
+  }
+
+private:
+  size_t size_ = 0;
+  std::vector<std::vector<uint64_t>> levels_; // levels_[0]: one bit per tick
+};
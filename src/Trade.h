@@ -1,13 +1,15 @@
 #pragma once
 #include <cstdint>
-#include <string>
+#include "Order.h"
 
 struct Trade {
     uint64_t   tradeId;
     uint64_t   buyOrderId;
     uint64_t   sellOrderId;
-    std::string symbol;
-    double     price;
+    SymbolId   symbol;
+    Price      price;      // ticks
     uint64_t   quantity;
     uint64_t   timestamp;
+    uint32_t   buySession = 0;  // Order::session of each side
+    uint32_t   sellSession = 0;
 };
\ No newline at end of file
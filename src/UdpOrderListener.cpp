@@ -0,0 +1,265 @@
+#include "UdpOrderListener.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include "BinaryProtocol.h"
+#include "Clock.h"
+
+namespace asio = boost::asio;
+using udp = asio::ip::udp;
+
+namespace
+{
+  // Largest datagram taken whole; longer ones are truncated and counted as
+  // malformed. Fits 60 or so orders.
+  constexpr size_t kMaxDatagram = 2048;
+  // How long a receive waits before checking for stop().
+  constexpr long kPollMicros = 100'000;
+  // How often senderStats() is refreshed, and how long a silent sender is
+  // remembered.
+  constexpr auto kPublishEvery = std::chrono::milliseconds(100);
+  constexpr auto kSenderIdle = std::chrono::minutes(1);
+
+  // Single writer: a plain load and store instead of a locked add.
+  void bump(std::atomic<uint64_t> &counter, uint64_t by = 1)
+  {
+    counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+  }
+}
+
+UdpOrderListener::UdpOrderListener(ShardedEngine &engines, unsigned short port, size_t batch,
+                                   size_t maxSenders)
+    : engines_(engines),
+      socket_(ioc_, udp::endpoint(udp::v4(), port)),
+      port_(socket_.local_endpoint().port()),
+      session_(engines.openSession()),
+      batch_(std::max<size_t>(1, batch)),
+      maxSenders_(maxSenders),
+      buffers_(batch_ * kMaxDatagram),
+      sizes_(batch_)
+#if defined(__linux__)
+      ,
+      msgs_(batch_),
+      iov_(batch_)
+#endif
+{
+  if (!session_)
+    throw std::runtime_error("UDP order entry: session limit reached");
+
+#if defined(__linux__)
+  for (size_t i = 0; i < batch_; ++i)
+  {
+    iov_[i] = {&buffers_[i * kMaxDatagram], kMaxDatagram};
+    msgs_[i].msg_hdr.msg_iov = &iov_[i];
+    msgs_[i].msg_hdr.msg_iovlen = 1;
+  }
+#endif
+
+  timeval timeout{0, kPollMicros};
+  setsockopt(socket_.native_handle(), SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+}
+
+UdpOrderListener::~UdpOrderListener()
+{
+  stop();
+}
+
+void UdpOrderListener::start(std::function<void()> onThreadStart)
+{
+  running_.store(true, std::memory_order_relaxed);
+  thread_ = std::thread([this, onThreadStart]
+                        {
+                          if (onThreadStart)
+                            onThreadStart();
+                          run();
+                        });
+}
+
+void UdpOrderListener::stop()
+{
+  running_.store(false, std::memory_order_relaxed);
+  if (thread_.joinable())
+    thread_.join();
+}
+
+UdpStats UdpOrderListener::stats() const
+{
+  return {reads_.load(std::memory_order_relaxed),
+          datagrams_.load(std::memory_order_relaxed),
+          orders_.load(std::memory_order_relaxed),
+          rejected_.load(std::memory_order_relaxed),
+          malformed_.load(std::memory_order_relaxed),
+          untracked_.load(std::memory_order_relaxed)};
+}
+
+std::vector<SenderStats> UdpOrderListener::senderStats() const
+{
+  std::lock_guard<std::mutex> lock(snapshotMutex_);
+  return snapshot_;
+}
+
+void UdpOrderListener::run()
+{
+  published_ = std::chrono::steady_clock::now();
+  while (running_.load(std::memory_order_relaxed))
+  {
+    size_t n = receive();
+    now_ = std::chrono::steady_clock::now();
+    if (n > 0)
+    {
+      bump(reads_);
+      bump(datagrams_, n);
+      for (size_t i = 0; i < n && running_.load(std::memory_order_relaxed); ++i)
+        handle(&buffers_[i * kMaxDatagram], sizes_[i]);
+    }
+    if (now_ - published_ >= kPublishEvery)
+      publishSenders();
+  }
+  publishSenders();
+}
+
+void UdpOrderListener::publishSenders()
+{
+  std::vector<SenderStats> snapshot;
+  snapshot.reserve(senders_.size());
+  for (auto it = senders_.begin(); it != senders_.end();)
+  {
+    if (now_ - it->second.lastSeen >= kSenderIdle)
+    {
+      it = senders_.erase(it);
+      continue;
+    }
+    snapshot.push_back(it->second.stats);
+    ++it;
+  }
+  published_ = now_;
+  std::lock_guard<std::mutex> lock(snapshotMutex_);
+  snapshot_.swap(snapshot);
+}
+
+#if defined(__linux__)
+
+size_t UdpOrderListener::receive()
+{
+  // One syscall: wait for the first datagram, then take whatever else is
+  // already queued, up to batch_.
+  int n = recvmmsg(socket_.native_handle(), msgs_.data(), static_cast<unsigned>(batch_),
+                   MSG_WAITFORONE, nullptr);
+  if (n <= 0)
+  {
+    if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+      std::cerr << "UDP order entry: recvmmsg: " << std::strerror(errno) << "\n";
+    return 0;
+  }
+  for (int i = 0; i < n; ++i)
+  {
+    // Truncated: pass on as empty, which handle() counts as malformed.
+    const mmsghdr &m = msgs_[i];
+    sizes_[i] = m.msg_hdr.msg_flags & MSG_TRUNC ? 0 : m.msg_len;
+  }
+  return static_cast<size_t>(n);
+}
+
+#else
+
+size_t UdpOrderListener::receive()
+{
+  // One recvfrom() per datagram: block for the first, then take the rest
+  // of what is queued.
+  size_t n = 0;
+  while (n < batch_)
+  {
+    ssize_t got = recvfrom(socket_.native_handle(), &buffers_[n * kMaxDatagram], kMaxDatagram,
+                           n == 0 ? 0 : MSG_DONTWAIT, nullptr, nullptr);
+    if (got < 0)
+      break;
+    sizes_[n++] = static_cast<size_t>(got);
+  }
+  return n;
+}
+
+#endif
+
+void UdpOrderListener::handle(const char *data, size_t size)
+{
+  DatagramHeader header;
+  if (size < sizeof(header))
+  {
+    bump(malformed_);
+    return;
+  }
+  std::memcpy(&header, data, sizeof(header));
+  if (header.version != kBinaryVersion)
+  {
+    bump(malformed_);
+    return;
+  }
+  if (!sequence(header.sender, header.sequence))
+    return;
+
+  const SymbolDirectory &symbols = engines_.symbols();
+  uint64_t received = SystemClock::read(); // the wire carries no timestamp
+  size_t used = sizeof(header);
+  while (used < size)
+  {
+    Order o;
+    size_t n = 0;
+    BinaryReject reason{};
+    DecodeStatus status = decodeMessage(data + used, size - used, o, n, reason);
+    o.timestamp = received;
+    if (status == DecodeStatus::Incomplete || status == DecodeStatus::BadFrame)
+    {
+      // The rest of the datagram cannot be framed.
+      bump(malformed_);
+      return;
+    }
+    used += n;
+    if (status == DecodeStatus::Rejected || o.symbol >= symbols.size())
+    {
+      bump(rejected_);
+      continue;
+    }
+
+    // Wait out a full lane (the kernel buffers meanwhile), unless stopping.
+    RejectReason rejected;
+    while (!session_->trySubmit(o, rejected))
+    {
+      if (!running_.load(std::memory_order_relaxed))
+        return;
+      std::this_thread::yield();
+    }
+    bump(rejected == RejectReason::None ? orders_ : rejected_);
+  }
+}
+
+bool UdpOrderListener::sequence(uint32_t sender, uint64_t seq)
+{
+  auto it = senders_.find(sender);
+  bool first = it == senders_.end();
+  if (first)
+  {
+    if (senders_.size() >= maxSenders_)
+    {
+      bump(untracked_);
+      return true;
+    }
+    it = senders_.emplace(sender, Sender{{sender, 0, 0, 0, 0}, now_}).first;
+  }
+  it->second.lastSeen = now_;
+  SenderStats &s = it->second.stats;
+  if (!first && seq != 1 && seq <= s.lastSequence)
+  {
+    ++s.stale;
+    return false;
+  }
+  // The first datagram seen (or a restart at 1) sets the baseline.
+  if (!first && seq != 1)
+    s.gaps += seq - s.lastSequence - 1;
+  s.lastSequence = seq;
+  ++s.datagrams;
+  return true;
+}
@@ -0,0 +1,127 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <boost/asio.hpp>
+#if defined(__linux__)
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
+#include "ShardedEngine.h"
+
+// Totals since the listener started.
+struct UdpStats
+{
+  uint64_t reads;     // receive syscalls that returned data
+  uint64_t datagrams; // datagrams received
+  uint64_t orders;    // orders handed to the engine
+  uint64_t rejected;  // invalid orders, or refused for overload
+  uint64_t malformed; // datagrams (or their tails) that could not be decoded
+  uint64_t untracked; // datagrams taken without sequence checks: sender table full
+};
+
+// Sequence tracking for one sender.
+struct SenderStats
+{
+  uint32_t sender;
+  uint64_t datagrams; // accepted in sequence
+  uint64_t gaps;      // datagrams skipped over: lost, or still in flight
+  uint64_t stale;     // duplicates and late arrivals, dropped
+  uint64_t lastSequence;
+};
+
+// Fire-and-forget order entry over UDP. Datagrams carry binary messages
+// behind a DatagramHeader (see BinaryProtocol.h) and are read up to
+// `batch` per recvmmsg() call on one dedicated thread, which submits them
+// through its own ShardedEngine::Session - the same lanes the TCP
+// connections feed. Nothing is sent back: rejects, lost datagrams and
+// out-of-order ones only show up in the stats.
+//
+// A datagram older than the sender's last one is dropped rather than
+// applied out of order. When the engine backs up, the thread waits and
+// the socket's receive buffer absorbs what it can; beyond that the kernel
+// drops datagrams, and senders see gaps.
+//
+// Up to `maxSenders` senders are tracked at a time. One silent for a
+// minute is forgotten, and its next datagram sets a new baseline; while
+// the table is full, datagrams from new senders are taken unchecked.
+//
+// recvmmsg() is Linux-only; elsewhere a batch is gathered with one
+// recvfrom() per datagram.
+class UdpOrderListener
+{
+public:
+  // Listen on `port` (0 picks a free one) on all IPv4 interfaces.
+  // Throws if the engine has no session left.
+  UdpOrderListener(ShardedEngine &engines, unsigned short port, size_t batch = 64,
+                   size_t maxSenders = 1024);
+  ~UdpOrderListener();
+
+  UdpOrderListener(const UdpOrderListener &) = delete;
+  UdpOrderListener &operator=(const UdpOrderListener &) = delete;
+
+  // Spawn the receive thread; `onThreadStart` runs first on it.
+  void start(std::function<void()> onThreadStart = {});
+  // Stop receiving (within about 100ms) and join the thread.
+  void stop();
+
+  unsigned short port() const { return port_; }
+  UdpStats stats() const;
+  // As of the receive thread's last snapshot, taken every 100ms or so and
+  // when it stops.
+  std::vector<SenderStats> senderStats() const;
+
+private:
+  void run();
+  // Returns the number of datagrams now in buffers_, waiting for the first.
+  size_t receive();
+  void handle(const char *data, size_t size);
+  // False if the datagram is stale and must be dropped.
+  bool sequence(uint32_t sender, uint64_t seq);
+  // Forget idle senders and snapshot the rest for senderStats().
+  void publishSenders();
+
+  ShardedEngine &engines_;
+  boost::asio::io_context ioc_;
+  boost::asio::ip::udp::socket socket_;
+  unsigned short port_;
+  std::unique_ptr<ShardedEngine::Session> session_;
+  size_t batch_;
+  size_t maxSenders_;
+  std::vector<char> buffers_; // batch_ receive buffers, back to back
+  std::vector<size_t> sizes_; // received length of each
+#if defined(__linux__)
+  std::vector<mmsghdr> msgs_; // recvmmsg() descriptors for buffers_
+  std::vector<iovec> iov_;
+#endif
+  std::atomic<bool> running_{false};
+  std::thread thread_;
+
+  // Written by the receive thread only.
+  std::atomic<uint64_t> reads_{0};
+  std::atomic<uint64_t> datagrams_{0};
+  std::atomic<uint64_t> orders_{0};
+  std::atomic<uint64_t> rejected_{0};
+  std::atomic<uint64_t> malformed_{0};
+  std::atomic<uint64_t> untracked_{0};
+
+  struct Sender
+  {
+    SenderStats stats;
+    std::chrono::steady_clock::time_point lastSeen;
+  };
+  // Receive thread only.
+  std::unordered_map<uint32_t, Sender> senders_;
+  std::chrono::steady_clock::time_point now_; // when the current batch arrived
+  std::chrono::steady_clock::time_point published_;
+
+  mutable std::mutex snapshotMutex_;
+  std::vector<SenderStats> snapshot_;
+};
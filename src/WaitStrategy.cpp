@@ -0,0 +1,24 @@
+#include "WaitStrategy.h"
+
+WaitMode parseWaitMode(const std::string &name)
+{
+  if (name == "spin")
+    return WaitMode::Spin;
+  if (name == "yield")
+    return WaitMode::SpinYield;
+  return WaitMode::Block;
+}
+
+const char *waitModeName(WaitMode mode)
+{
+  switch (mode)
+  {
+  case WaitMode::Spin:
+    return "spin";
+  case WaitMode::SpinYield:
+    return "yield";
+  case WaitMode::Block:
+    break;
+  }
+  return "block";
+}
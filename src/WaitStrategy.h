@@ -0,0 +1,129 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// How an engine thread waits when its input queue is empty.
+//   Spin      - busy-poll with a CPU pause hint: lowest wake-up latency,
+//               burns a core.
+//   SpinYield - poll for a while, then yield the CPU between polls.
+//   Block     - sleep on a condition variable until a producer notify()s.
+enum class WaitMode { Spin, SpinYield, Block };
+
+// "spin", "yield" or "block"; anything else is Block.
+WaitMode parseWaitMode(const std::string &name);
+const char *waitModeName(WaitMode mode);
+
+inline void cpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  __asm__ __volatile__("yield");
+#endif
+}
+
+// Consumer side is single-threaded (the engine thread); notify() may be
+// called from any producer. Idle time is accumulated for metrics.
+class WaitStrategy
+{
+public:
+  explicit WaitStrategy(WaitMode mode = WaitMode::Block, unsigned spins = 4096)
+      : mode_(mode), spins_(spins) {}
+
+  WaitStrategy(const WaitStrategy &) = delete;
+  WaitStrategy &operator=(const WaitStrategy &) = delete;
+
+  WaitMode mode() const { return mode_; }
+
+  // Returns once ready() holds, waiting in the configured way.
+  template <class Ready>
+  void waitUntil(Ready ready)
+  {
+    if (ready())
+      return;
+    auto start = std::chrono::steady_clock::now();
+    switch (mode_)
+    {
+    case WaitMode::Spin:
+      while (!ready())
+        cpuRelax();
+      break;
+    case WaitMode::SpinYield:
+      for (unsigned i = 0; !ready(); ++i)
+      {
+        if (i < spins_)
+          cpuRelax();
+        else
+          std::this_thread::yield();
+      }
+      break;
+    case WaitMode::Block:
+      block(ready);
+      break;
+    }
+    idleNs_ += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now() - start)
+                   .count();
+    ++idlePeriods_;
+  }
+
+  // Wake a blocked consumer. Call after publishing work; cheap (one fence
+  // and a load) when nobody is asleep.
+  void notify()
+  {
+    if (mode_ != WaitMode::Block)
+      return;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers_.load(std::memory_order_relaxed) == 0)
+      return;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      signalled_ = true;
+    }
+    cv_.notify_one();
+  }
+
+  uint64_t idleNanos() const { return idleNs_; }
+  uint64_t idlePeriods() const { return idlePeriods_; }
+
+private:
+  // Upper bound on one sleep, as a backstop should a notify go missing.
+  static constexpr std::chrono::milliseconds kMaxBlock{1};
+
+  template <class Ready>
+  void block(Ready &ready)
+  {
+    while (!ready())
+    {
+      // Announce ourselves before the final check so a producer that
+      // enqueues after it is guaranteed to see sleepers_ != 0.
+      sleepers_.fetch_add(1, std::memory_order_seq_cst);
+      if (!ready())
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait_for(lock, kMaxBlock, [this]
+                     { return signalled_; });
+        signalled_ = false;
+      }
+      sleepers_.fetch_sub(1, std::memory_order_relaxed);
+    }
+  }
+
+  WaitMode mode_;
+  unsigned spins_;
+  uint64_t idleNs_ = 0;
+  uint64_t idlePeriods_ = 0;
+
+  std::atomic<uint32_t> sleepers_{0};
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool signalled_ = false;
+};
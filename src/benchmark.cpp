@@ -4,6 +4,7 @@
 #include <chrono>
 #include "MatchingEngine.h"
 #include "Order.h"
+#include "SymbolDirectory.h"
 
 using namespace std;
 using clk = chrono::high_resolution_clock;
@@ -11,7 +12,15 @@ using ns  = chrono::nanoseconds;
 
 int main(int argc, char* argv[]) {
     const size_t N = (argc>1 ? stoull(argv[1]) : 1'000'000);
-    MatchingEngine engine;
+    const string bookType = (argc>2 ? argv[2] : "map");   // map | array
+
+    auto symbols = make_shared<SymbolDirectory>();
+    if (bookType == "array")
+        symbols->setBookType("AAPL", BookType::Array);
+    const SymbolId aapl = symbols->intern("AAPL");
+    MatchingEngine engine(symbols);
+    // Logical event time keeps trade timestamps reproducible across runs.
+    engine.setClock(make_shared<LogicalClock>());
 
     vector<Order> orders;
     orders.reserve(N);
@@ -19,10 +28,10 @@ int main(int argc, char* argv[]) {
         Order o;
         o.orderId   = i+1;
         o.accountId = 1;
-        o.symbol    = "AAPL";
+        o.symbol    = aapl;
         o.side      = (i%2==0 ? Side::BUY : Side::SELL);
         o.type      = OrderType::LIMIT;
-        o.price     = 100.0 + (i%100)*0.01;
+        o.price     = 10000 + static_cast<Price>(i%100);  // ticks of 0.01
         o.quantity  = 1;
         o.timestamp = chrono::duration_cast<ns>(clk::now().time_since_epoch()).count();
         orders.push_back(o);
@@ -30,11 +39,14 @@ int main(int argc, char* argv[]) {
 
     vector<uint64_t> latencies;
     latencies.reserve(N);
+    vector<Trade> trades;
+    trades.reserve(1024);
 
     auto start_all = clk::now();
     for (auto& o : orders) {
         auto t0 = clk::now();
-        engine.onNewOrder(o);
+        trades.clear();
+        engine.onNewOrder(o, trades);
         auto t1 = clk::now();
         latencies.push_back(
           chrono::duration_cast<ns>(t1 - t0).count()
@@ -48,11 +60,15 @@ int main(int argc, char* argv[]) {
     auto p99 = latencies[size_t(N*0.99)];
     double throughput = double(N) / chrono::duration<double>(end_all - start_all).count();
 
-    cout << "Ran " << N << " orders in "
+    cout << "Ran " << N << " orders (" << bookType << " book) in "
          << chrono::duration<double>(end_all - start_all).count() << " s\n";
     cout << " Throughput = " << throughput << " orders/s\n";
     cout << " Latency p50  = " << p50  << " ns\n";
     cout << " Latency p90  = " << p90  << " ns\n";
     cout << " Latency p99  = " << p99  << " ns\n";
+    const auto& pools = engine.pools();
+    cout << " Order pool   = " << pools.orders.slab().inUse() << " in use / "
+         << pools.orders.slab().capacity() << " capacity ("
+         << pools.orders.slab().slabs() << " slabs)\n";
     return 0;
 }
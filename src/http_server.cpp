@@ -2,6 +2,7 @@
 #include <boost/beast/core.hpp>
 #include <boost/beast/http.hpp>
 #include <nlohmann/json.hpp>
+#include <algorithm>
 #include "http_server.h"
 
 namespace asio = boost::asio;
@@ -13,7 +14,7 @@ using json = nlohmann::json;
 static void handle_request(
     const http::request<http::string_body> &req,
     std::shared_ptr<beast::tcp_stream> stream,
-    MatchingEngine &engine)
+    ShardedEngine &engines)
 {
   std::string target(req.target().data(), req.target().size());
 
@@ -37,8 +38,9 @@ static void handle_request(
   if (req.method() == http::verb::get && target.rfind("/book/", 0) == 0)
   {
     auto pos = target.find('?');
-    std::string sym = target.substr(6,
-                                    pos == std::string::npos ? std::string::npos : pos - 6);
+    std::string name = target.substr(6,
+                                     pos == std::string::npos ? std::string::npos : pos - 6);
+    SymbolId sym = engines.symbols().find(name);
     size_t depth = 10;
     if (pos != std::string::npos &&
         target.substr(pos).rfind("?depth=", 0) == 0)
@@ -46,11 +48,27 @@ static void handle_request(
       depth = std::stoul(target.substr(pos + 7));
     }
 
-    auto levels = engine.snapshotBook(sym, depth);
     json j;
     j["bids"] = json::array();
-    for (auto &lvl : levels)
-      j["bids"].push_back({{"price", lvl.price}, {"qty", lvl.quantity}});
+    j["asks"] = json::array();
+    BookView view;
+    uint64_t version = 0;
+    if (sym != SymbolDirectory::kInvalid)
+      version = engines.views().read(sym, view);
+    if (version)
+    {
+      double tick = engines.symbols().tickSize(sym);
+      auto levels = [&](json &out, const BookLevel *lvls, size_t n)
+      {
+        for (size_t i = 0; i < std::min(n, depth); ++i)
+          out.push_back({{"price", fromTicks(lvls[i].price, tick)},
+                         {"qty", lvls[i].quantity},
+                         {"orders", lvls[i].orders}});
+      };
+      levels(j["bids"], view.bids, view.bidCount);
+      levels(j["asks"], view.asks, view.askCount);
+      j["version"] = version;
+    }
 
     res.body() = j.dump();
     res.prepare_payload();
@@ -62,8 +80,9 @@ static void handle_request(
   if (req.method() == http::verb::get && target.rfind("/trades/", 0) == 0)
   {
     auto pos = target.find('?');
-    std::string sym = target.substr(8,
-                                    pos == std::string::npos ? std::string::npos : pos - 8);
+    std::string name = target.substr(8,
+                                     pos == std::string::npos ? std::string::npos : pos - 8);
+    SymbolId sym = engines.symbols().find(name);
     size_t limit = 10;
     if (pos != std::string::npos &&
         target.substr(pos).rfind("?limit=", 0) == 0)
@@ -71,15 +90,19 @@ static void handle_request(
       limit = std::stoul(target.substr(pos + 7));
     }
 
-    auto recent = engine.recentTrades(sym, limit);
     json j = json::array();
-    for (auto &t : recent)
+    BookView view;
+    if (sym != SymbolDirectory::kInvalid && engines.views().read(sym, view))
     {
-      j.push_back({{"tradeId", t.tradeId},
-                   {"price", t.price},
-                   {"qty", t.quantity},
-                   {"buyOrderId", t.buyOrderId},
-                   {"sellOrderId", t.sellOrderId}});
+      double tick = engines.symbols().tickSize(sym);
+      for (auto &t : view.recentTrades(limit))
+      {
+        j.push_back({{"tradeId", t.tradeId},
+                     {"price", fromTicks(t.price, tick)},
+                     {"qty", t.quantity},
+                     {"buyOrderId", t.buyOrderId},
+                     {"sellOrderId", t.sellOrderId}});
+      }
     }
 
     res.body() = j.dump();
@@ -88,6 +111,22 @@ static void handle_request(
     return;
   }
 
+  // — GET /symbols → ids and tick sizes, for binary order entry
+  if (req.method() == http::verb::get && target == "/symbols")
+  {
+    const SymbolDirectory &symbols = engines.symbols();
+    json j = json::array();
+    for (SymbolId id = 0; id < symbols.size(); ++id)
+      j.push_back({{"symbol", symbols.name(id)},
+                   {"id", id},
+                   {"tickSize", symbols.tickSize(id)}});
+
+    res.body() = j.dump();
+    res.prepare_payload();
+    http::write(*stream, res);
+    return;
+  }
+
   res.result(http::status::not_found);
   res.body() = R"({"error":"unknown endpoint"})";
   res.prepare_payload();
@@ -96,7 +135,7 @@ static void handle_request(
 
 void run_http_server(asio::io_context &ioc,
                      unsigned short port,
-                     MatchingEngine &engine)
+                     ShardedEngine &engines)
 {
   tcp::acceptor acceptor{ioc, {tcp::v4(), port}};
   for (;;)
@@ -106,6 +145,6 @@ void run_http_server(asio::io_context &ioc,
     beast::flat_buffer buffer;
     http::request<http::string_body> req;
     http::read(*stream, buffer, req);
-    handle_request(req, stream, engine);
+    handle_request(req, stream, engines);
   }
 }
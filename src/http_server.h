@@ -1,12 +1,15 @@
 #pragma once
 #include <boost/asio.hpp>
-#include "MatchingEngine.h"
+#include "ShardedEngine.h"
 
 namespace asio = boost::asio;
 
 /// Runs a blocking loop that serves:
 ///  - GET /book/{symbol}?depth={n}   → JSON order‐book snapshot
 ///  - GET /trades/{symbol}?limit={n} → JSON recent trades
+///  - GET /symbols                   → symbol ids and tick sizes
+/// Both read the engines' published MarketViews, never live books, so
+/// requests never race or block matching.
 void run_http_server(asio::io_context&  ioc,
                      unsigned short     port,
-                     MatchingEngine&    engine);
+                     ShardedEngine&     engines);
@@ -1,24 +1,36 @@
+#include <algorithm>
 #include <iostream>
 #include <thread>
 #include <fstream>
 #include <chrono>
-#include <sstream>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include <boost/asio.hpp>
 #include <rdkafkacpp.h>
 #include <concurrentqueue.h>
 #include <nlohmann/json.hpp>
 
+#include "EventChannel.h"
 #include "Order.h"
+#include "OrderEntryServer.h"
 #include "MatchingEngine.h"
+#include "ShardedEngine.h"
+#include "Histogram.h"
+#include "SymbolDirectory.h"
+#include "ThreadConfig.h"
+#include "UdpOrderListener.h"
+#include "WaitStrategy.h"
 #include "http_server.h"
 
 using json = nlohmann::json;
-using tcp = boost::asio::ip::tcp;
 namespace chrono = std::chrono;
 
 // ----------------------------------------------------------------------------
-// Helper: serialize a json object and publish to a Kafka topic
+// Helper: serialize a json object and publish to a Kafka topic (the caller
+// polls the producer for delivery callbacks)
 // ----------------------------------------------------------------------------
 void produceJson(RdKafka::Producer *producer,
                  RdKafka::Topic *topic,
@@ -32,119 +44,384 @@ void produceJson(RdKafka::Producer *producer,
       const_cast<char *>(payload.data()),
       payload.size(),
       nullptr, 0, nullptr);
-  producer->poll(0);
 }
 
 // ----------------------------------------------------------------------------
-// Engine thread: consume orders, log, match, log trades, emit Kafka metrics
+// Engine thread (one per shard): drain up to `batchSize` orders at a time
+// from the session lanes, match them back to back, queue execution reports
+// for the sessions involved, refresh the shard's market views and hand
+// orders, fills and batch stats to the shard's publisher. Nothing here
+// touches disk, Kafka or a socket.
 // ----------------------------------------------------------------------------
-void engineLoop(moodycamel::ConcurrentQueue<Order> &inQ,
-                MatchingEngine &engine,
-                std::ofstream &orderLog,
-                std::ofstream &tradeLog,
-                RdKafka::Producer *producer,
-                RdKafka::Topic *topicOrders,
-                RdKafka::Topic *topicTrades,
-                RdKafka::Topic *topicMetrics)
+void engineLoop(ShardedEngine &engines,
+                size_t shard,
+                size_t batchSize,
+                EventChannel &out)
 {
-  Order o;
-  size_t orderCount = 0;
-  auto windowStart = chrono::high_resolution_clock::now();
+  MatchingEngine &engine = engines.engine(shard);
+  WaitStrategy &wait = engines.waiter(shard);
+  MarketViews &views = engines.views();
+  std::vector<Order> batch(batchSize);
+  std::vector<Trade> trades; // reused across batches
+  trades.reserve(1024);
 
   while (true)
   {
-    if (!inQ.try_dequeue(o))
+    size_t n = engines.drain(shard, batch.data(), batchSize);
+    if (n == 0)
     {
-      std::this_thread::sleep_for(chrono::milliseconds(1));
+      wait.waitUntil([&]
+                     { return engines.hasInput(shard); });
       continue;
     }
 
+    auto t0 = chrono::high_resolution_clock::now();
+    trades.clear();
+    for (size_t i = 0; i < n; ++i)
+    {
+      size_t first = trades.size();
+      bool applied = engine.onNewOrder(batch[i], trades);
+      engines.report(shard, batch[i], applied, trades.data() + first, trades.size() - first);
+    }
+    auto t1 = chrono::high_resolution_clock::now();
+    engines.flushReports(shard);
+    engine.publishViews(views);
+
+    for (size_t i = 0; i < n; ++i)
+      out.push(batch[i]);
+    for (auto &t : trades)
+      out.push(t);
+    out.push(BatchStats{
+        static_cast<uint32_t>(n),
+        static_cast<uint64_t>(
+            chrono::duration_cast<chrono::nanoseconds>(t1 - t0).count()),
+        static_cast<int64_t>(
+            chrono::duration_cast<chrono::nanoseconds>(t1.time_since_epoch()).count()),
+        wait.idleNanos()});
+    out.publish();
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Publisher thread (one per shard): journal orders and trades, publish them
+// to Kafka and emit per-second metrics, flushing whenever the ring drains.
+// `udp`, if given, is reported on by one publisher only.
+// ----------------------------------------------------------------------------
+void publisherLoop(EventChannel &in,
+                   const ShardedEngine &engines,
+                   size_t shard,
+                   WaitMode waitMode,
+                   std::ofstream &orderLog,
+                   std::ofstream &tradeLog,
+                   RdKafka::Producer *producer,
+                   RdKafka::Topic *topicOrders,
+                   RdKafka::Topic *topicTrades,
+                   RdKafka::Topic *topicMetrics,
+                   const UdpOrderListener *udp)
+{
+  Histogram batchSizes;
+  Histogram batchLatency; // ns to match one batch
+  size_t orderCount = 0;
+  uint64_t idleAtWindowStart = 0;
+  uint64_t droppedAtWindowStart = 0;
+  uint64_t rejectedAtWindowStart = 0;
+  uint64_t matchNsInWindow = 0;
+  PriorityStats priorityAtWindowStart{0, 0, 0};
+  int64_t windowStart = 0;
+  std::unordered_map<uint32_t, uint64_t> acceptedAtWindowStart; // by session
+  UdpStats udpAtWindowStart{0, 0, 0, 0, 0, 0};
+  std::unordered_map<uint32_t, SenderStats> sendersAtWindowStart;
+  const SymbolDirectory &symbols = engines.symbols();
+  EngineEvent e;
+
+  auto onOrder = [&](const Order &o)
+  {
     orderLog
         << o.orderId << ','
         << static_cast<int>(o.type) << ','
         << static_cast<int>(o.side) << ','
         << o.price << ','
         << o.quantity << '\n';
-    orderLog.flush();
 
-    {
-      json jo = {
-          {"orderId", o.orderId},
-          {"accountId", o.accountId},
-          {"symbol", o.symbol},
-          {"side", static_cast<int>(o.side)},
-          {"type", static_cast<int>(o.type)},
-          {"price", o.price},
-          {"quantity", o.quantity},
-          {"timestamp", o.timestamp}};
-      produceJson(producer, topicOrders, jo);
-    }
+    json jo = {
+        {"orderId", o.orderId},
+        {"accountId", o.accountId},
+        {"symbol", symbols.name(o.symbol)},
+        {"side", static_cast<int>(o.side)},
+        {"type", static_cast<int>(o.type)},
+        {"price", fromTicks(o.price, symbols.tickSize(o.symbol))},
+        {"quantity", o.quantity},
+        {"timestamp", o.timestamp}};
+    produceJson(producer, topicOrders, jo);
+  };
 
-    auto t0 = chrono::high_resolution_clock::now();
-    auto trades = engine.onNewOrder(o);
-    auto t1 = chrono::high_resolution_clock::now();
-    auto latency_ns = chrono::duration_cast<chrono::nanoseconds>(t1 - t0).count();
+  auto onTrade = [&](const Trade &t)
+  {
+    tradeLog
+        << t.tradeId << ','
+        << t.buyOrderId << ','
+        << t.sellOrderId << ','
+        << t.price << ','
+        << t.quantity << '\n';
+
+    json jt = {
+        {"tradeId", t.tradeId},
+        {"buyOrderId", t.buyOrderId},
+        {"sellOrderId", t.sellOrderId},
+        {"symbol", symbols.name(t.symbol)},
+        {"price", fromTicks(t.price, symbols.tickSize(t.symbol))},
+        {"quantity", t.quantity},
+        {"timestamp", t.timestamp}};
+    produceJson(producer, topicTrades, jt);
+  };
 
+  auto onBatch = [&](const BatchStats &b)
+  {
+    batchSizes.record(b.orders);
+    batchLatency.record(b.latencyNs);
     {
+      // Matching time amortised over the batch.
       json m = {
           {"metric", "order_latency_ns"},
-          {"value", latency_ns},
-          {"symbol", o.symbol},
-          {"timestamp", static_cast<int64_t>(
-                            chrono::duration_cast<chrono::nanoseconds>(
-                                t1.time_since_epoch())
-                                .count())}};
+          {"value", b.latencyNs / b.orders},
+          {"timestamp", b.timestamp}};
       produceJson(producer, topicMetrics, m);
     }
 
-    orderCount++;
-    auto now = chrono::high_resolution_clock::now();
-    if (now - windowStart >= chrono::seconds(1))
+    orderCount += b.orders;
+    matchNsInWindow += b.latencyNs;
+    if (windowStart == 0)
+      windowStart = b.timestamp;
+    if (b.timestamp - windowStart < 1'000'000'000)
+      return;
+
+    json m = {
+        {"metric", "orders_per_sec"},
+        {"value", static_cast<int>(orderCount)},
+        {"timestamp", b.timestamp}};
+    produceJson(producer, topicMetrics, m);
+
+    json idle = {
+        {"metric", "engine_idle_ns"},
+        {"value", b.idleNs - idleAtWindowStart},
+        {"wait", waitModeName(waitMode)},
+        {"timestamp", b.timestamp}};
+    produceJson(producer, topicMetrics, idle);
+
+    const std::pair<const char *, double> quantiles[] = {{"p50", 0.50}, {"p99", 0.99}};
+    for (const auto &q : quantiles)
     {
-      json m = {
-          {"metric", "orders_per_sec"},
-          {"value", static_cast<int>(orderCount)},
-          {"timestamp", static_cast<int64_t>(
-                            chrono::duration_cast<chrono::nanoseconds>(
-                                now.time_since_epoch())
-                                .count())}};
-      produceJson(producer, topicMetrics, m);
-      orderCount = 0;
-      windowStart = now;
+      produceJson(producer, topicMetrics,
+                  {{"metric", std::string("batch_size_") + q.first},
+                   {"value", batchSizes.percentile(q.second)},
+                   {"timestamp", b.timestamp}});
+      produceJson(producer, topicMetrics,
+                  {{"metric", std::string("batch_latency_ns_") + q.first},
+                   {"value", batchLatency.percentile(q.second)},
+                   {"timestamp", b.timestamp}});
     }
 
-    for (auto &t : trades)
+    produceJson(producer, topicMetrics,
+                {{"metric", "publish_backlog"},
+                 {"value", in.backlog()},
+                 {"timestamp", b.timestamp}});
+    produceJson(producer, topicMetrics,
+                {{"metric", "publish_dropped"},
+                 {"value", in.dropped() - droppedAtWindowStart},
+                 {"timestamp", b.timestamp}});
+
+    // Shard-wide ingress: orders waiting for the engine, and orders refused
+    // above the high-water mark during the window.
+    uint64_t rejected = engines.rejected(shard);
+    produceJson(producer, topicMetrics,
+                {{"metric", "ingress_depth"},
+                 {"value", engines.depth(shard)},
+                 {"shard", shard},
+                 {"timestamp", b.timestamp}});
+    produceJson(producer, topicMetrics,
+                {{"metric", "ingress_rejected"},
+                 {"value", rejected - rejectedAtWindowStart},
+                 {"shard", shard},
+                 {"timestamp", b.timestamp}});
+    rejectedAtWindowStart = rejected;
+
+    // Cancel/replace priority lane: queued orders jumped (and the matching
+    // time they would have waited for), and queued orders pulled before
+    // they could match.
+    PriorityStats priority = engines.priorityStats(shard);
+    uint64_t overtaken = priority.overtaken - priorityAtWindowStart.overtaken;
+    produceJson(producer, topicMetrics,
+                {{"metric", "cancel_overtaken"},
+                 {"value", overtaken},
+                 {"shard", shard},
+                 {"timestamp", b.timestamp}});
+    produceJson(producer, topicMetrics,
+                {{"metric", "cancel_saved_ns"},
+                 {"value", overtaken * matchNsInWindow / std::max<size_t>(1, orderCount)},
+                 {"shard", shard},
+                 {"timestamp", b.timestamp}});
+    produceJson(producer, topicMetrics,
+                {{"metric", "cancel_matches_avoided"},
+                 {"value", priority.avoided - priorityAtWindowStart.avoided},
+                 {"shard", shard},
+                 {"timestamp", b.timestamp}});
+    priorityAtWindowStart = priority;
+
+    // Per-session ingress for this shard: backlog and accepted orders/s.
+    std::unordered_map<uint32_t, uint64_t> accepted;
+    for (const auto &st : engines.sessionStats(shard))
     {
-      tradeLog
-          << t.tradeId << ','
-          << t.buyOrderId << ','
-          << t.sellOrderId << ','
-          << t.price << ','
-          << t.quantity << '\n';
-      tradeLog.flush();
+      auto prev = acceptedAtWindowStart.find(st.session);
+      uint64_t base = prev == acceptedAtWindowStart.end() ? 0 : prev->second;
+      produceJson(producer, topicMetrics,
+                  {{"metric", "session_depth"},
+                   {"value", st.depth},
+                   {"session", st.session},
+                   {"timestamp", b.timestamp}});
+      produceJson(producer, topicMetrics,
+                  {{"metric", "session_orders_per_sec"},
+                   {"value", st.accepted - base},
+                   {"session", st.session},
+                   {"timestamp", b.timestamp}});
+      accepted[st.session] = st.accepted;
+    }
+    acceptedAtWindowStart.swap(accepted);
+
+    // UDP ingest: datagrams per receive syscall, orders dropped as invalid
+    // or undecodable, and per sender the datagrams missed (gaps) or
+    // dropped for arriving out of order (stale) during the window.
+    if (udp)
+    {
+      UdpStats u = udp->stats();
+      uint64_t reads = u.reads - udpAtWindowStart.reads;
+      produceJson(producer, topicMetrics,
+                  {{"metric", "udp_datagrams_per_read"},
+                   {"value", reads ? static_cast<double>(u.datagrams - udpAtWindowStart.datagrams) / reads : 0.0},
+                   {"timestamp", b.timestamp}});
+      produceJson(producer, topicMetrics,
+                  {{"metric", "udp_rejected"},
+                   {"value", u.rejected - udpAtWindowStart.rejected},
+                   {"timestamp", b.timestamp}});
+      produceJson(producer, topicMetrics,
+                  {{"metric", "udp_malformed"},
+                   {"value", u.malformed - udpAtWindowStart.malformed},
+                   {"timestamp", b.timestamp}});
+      produceJson(producer, topicMetrics,
+                  {{"metric", "udp_untracked"},
+                   {"value", u.untracked - udpAtWindowStart.untracked},
+                   {"timestamp", b.timestamp}});
+      udpAtWindowStart = u;
 
-      json jt = {
-          {"tradeId", t.tradeId},
-          {"buyOrderId", t.buyOrderId},
-          {"sellOrderId", t.sellOrderId},
-          {"symbol", t.symbol},
-          {"price", t.price},
-          {"quantity", t.quantity},
-          {"timestamp", t.timestamp}};
-      produceJson(producer, topicTrades, jt);
+      std::unordered_map<uint32_t, SenderStats> senders;
+      for (const auto &st : udp->senderStats())
+      {
+        // A sender expired and seen again starts from zero.
+        auto prev = sendersAtWindowStart.find(st.sender);
+        SenderStats base = prev == sendersAtWindowStart.end() ||
+                                   prev->second.datagrams > st.datagrams
+                               ? SenderStats{st.sender, 0, 0, 0, 0}
+                               : prev->second;
+        produceJson(producer, topicMetrics,
+                    {{"metric", "udp_sequence_gaps"},
+                     {"value", st.gaps - base.gaps},
+                     {"sender", st.sender},
+                     {"timestamp", b.timestamp}});
+        produceJson(producer, topicMetrics,
+                    {{"metric", "udp_stale"},
+                     {"value", st.stale - base.stale},
+                     {"sender", st.sender},
+                     {"timestamp", b.timestamp}});
+        senders[st.sender] = st;
+      }
+      sendersAtWindowStart.swap(senders);
+    }
+
+    orderCount = 0;
+    matchNsInWindow = 0;
+    batchSizes.reset();
+    batchLatency.reset();
+    idleAtWindowStart = b.idleNs;
+    droppedAtWindowStart = in.dropped();
+    windowStart = b.timestamp;
+  };
+
+  while (true)
+  {
+    if (!in.pop(e))
+    {
+      orderLog.flush();
+      tradeLog.flush();
+      producer->poll(0);
+      in.waitForEvents();
+      continue;
     }
+
+    if (auto *o = std::get_if<Order>(&e))
+      onOrder(*o);
+    else if (auto *t = std::get_if<Trade>(&e))
+      onTrade(*t);
+    else
+      onBatch(std::get<BatchStats>(e));
   }
 }
 
+// "orders.log" with one shard, "orders.<k>.log" per shard otherwise
+static std::string logName(const std::string &base, size_t shard, size_t shards)
+{
+  if (shards == 1)
+    return base + ".log";
+  return base + "." + std::to_string(shard) + ".log";
+}
+
 // ----------------------------------------------------------------------------
 // main(): setup Kafka, engine, HTTP, and TCP ingest
 // ----------------------------------------------------------------------------
 int main()
 {
-  moodycamel::ConcurrentQueue<Order> inQ;
-  MatchingEngine engine;
-  std::ofstream orderLog("orders.log", std::ios::app);
-  std::ofstream tradeLog("trades.log", std::ios::app);
+  auto symbols = std::make_shared<SymbolDirectory>();
+  if (const char *ticks = std::getenv("TICK_SIZES"))
+    symbols->loadTickSizes(ticks);
+  if (const char *books = std::getenv("ARRAY_BOOKS"))
+    symbols->loadArrayBooks(books);
+  if (const char *pins = std::getenv("SHARD_MAP"))
+    symbols->loadShards(pins);
+
+  size_t shardCount = 1;
+  if (const char *n = std::getenv("ENGINE_SHARDS"))
+    shardCount = std::max<size_t>(1, std::stoul(n));
+
+  WaitMode waitMode = WaitMode::Block;
+  if (const char *w = std::getenv("ENGINE_WAIT"))
+    waitMode = parseWaitMode(w);
+
+  size_t batchSize = 64;
+  if (const char *k = std::getenv("ENGINE_BATCH"))
+    batchSize = std::max<size_t>(1, std::stoul(k));
+
+  IngressConfig ingress;
+  if (const char *mode = std::getenv("INGRESS_MODE"))
+    ingress.mode = parseIngressMode(mode);
+  if (const char *ring = std::getenv("INGRESS_RING"))
+    ingress.ringCapacity = std::stoul(ring);
+  if (const char *lane = std::getenv("INGRESS_LANE"))
+    ingress.laneCapacity = std::stoul(lane);
+  if (const char *q = std::getenv("INGRESS_QUANTUM"))
+    ingress.quantum = std::stoul(q);
+  if (const char *c = std::getenv("INGRESS_CANCEL_LANE"))
+    ingress.cancelCapacity = std::stoul(c);
+  if (const char *hw = std::getenv("INGRESS_HIGH_WATER"))
+    ingress.highWater = std::stoul(hw);
+  if (const char *p = std::getenv("INGRESS_OVERLOAD"))
+    ingress.overload = parseOverloadPolicy(p);
+
+  ShardedEngine engines(shardCount, symbols, PoolConfig{}, waitMode, ingress);
+  std::vector<std::ofstream> orderLogs;
+  std::vector<std::ofstream> tradeLogs;
+  for (size_t k = 0; k < engines.size(); ++k)
+  {
+    orderLogs.emplace_back(logName("orders", k, engines.size()), std::ios::app);
+    tradeLogs.emplace_back(logName("trades", k, engines.size()), std::ios::app);
+  }
 
   std::string brokers = "localhost:9092";
   std::string errstr;
@@ -163,57 +440,80 @@ int main()
   auto *topicTrades = RdKafka::Topic::create(producer, "trades", nullptr, errstr);
   auto *topicMetrics = RdKafka::Topic::create(producer, "metrics", nullptr, errstr);
 
-  std::thread engThread(engineLoop,
-                        std::ref(inQ), std::ref(engine),
-                        std::ref(orderLog), std::ref(tradeLog),
-                        producer, topicOrders, topicTrades, topicMetrics);
+  size_t ringSize = 1u << 16;
+  if (const char *r = std::getenv("PUBLISH_RING"))
+    ringSize = std::stoul(r);
+  OverflowPolicy overflow = OverflowPolicy::Block;
+  if (const char *p = std::getenv("PUBLISH_OVERFLOW"))
+    overflow = parseOverflowPolicy(p);
+
+  size_t ingestThreads = 2;
+  if (const char *t = std::getenv("INGEST_THREADS"))
+    ingestThreads = std::max<size_t>(1, std::stoul(t));
+
+  // Optional fire-and-forget UDP order entry (binary datagrams).
+  std::unique_ptr<UdpOrderListener> udpEntry;
+  if (const char *port = std::getenv("ORDER_UDP_PORT"))
+  {
+    size_t batch = 64;
+    if (const char *b = std::getenv("ORDER_UDP_BATCH"))
+      batch = std::stoul(b);
+    udpEntry = std::make_unique<UdpOrderListener>(
+        engines, static_cast<unsigned short>(std::stoul(port)), batch);
+  }
+
+  const ThreadConfig placement = ThreadConfig::fromEnv();
+  std::cout << "Thread placement:\n"
+            << placement.describe(engines.size());
+
+  // One engine thread and one publisher thread per shard, joined by a ring.
+  std::vector<std::unique_ptr<EventChannel>> channels;
+  std::vector<std::thread> engThreads;
+  std::vector<std::thread> pubThreads;
+  for (size_t k = 0; k < engines.size(); ++k)
+  {
+    channels.push_back(std::make_unique<EventChannel>(ringSize, overflow));
+    EventChannel *channel = channels[k].get();
+    pubThreads.emplace_back([&, k, channel]
+                            {
+        placement.apply(ThreadRole::Publisher, k);
+        publisherLoop(*channel, engines, k, waitMode, orderLogs[k], tradeLogs[k],
+                      producer, topicOrders, topicTrades, topicMetrics,
+                      k == 0 ? udpEntry.get() : nullptr); });
+    engThreads.emplace_back([&, k, channel]
+                            {
+        placement.apply(ThreadRole::Engine, k);
+        engineLoop(engines, k, batchSize, *channel); });
+  }
 
   std::thread httpThread([&]()
                          {
+        placement.apply(ThreadRole::Http);
         boost::asio::io_context ioc{1};
-        run_http_server(ioc, 8080, engine); });
+        run_http_server(ioc, 8080, engines); });
   httpThread.detach();
 
-  boost::asio::io_context io_ctx{1};
-  tcp::acceptor acceptor(io_ctx, {tcp::v4(), 9000});
-  std::cout << "Matching engine listening on port 9000\n";
-
-  for (;;)
+  OrderEntryServer orderEntry(engines, 9000, ingestThreads);
+  orderEntry.addListener(9001, WireFormat::Binary, true);
+  orderEntry.addListener(9002, WireFormat::Csv, true);
+  std::cout << "Matching engine listening on ports 9000 (CSV), 9001 (binary) and 9002 (CSV with reports) ("
+            << engines.size() << " shard" << (engines.size() == 1 ? "" : "s")
+            << ", " << waitModeName(waitMode) << " wait, "
+            << orderEntry.threads() << " I/O thread"
+            << (orderEntry.threads() == 1 ? "" : "s") << ")\n";
+  if (udpEntry)
   {
-    tcp::socket socket(io_ctx);
-    acceptor.accept(socket);
-
-    std::thread([sock = std::move(socket), &inQ]() mutable
-                {
-            boost::asio::streambuf buf;
-            std::string line;
-
-            while (true) {
-                boost::system::error_code ec;
-                auto n = boost::asio::read_until(sock, buf, '\n', ec);
-                if (ec) break;
-
-                std::istream is(&buf);
-                std::getline(is, line);
-                buf.consume(n);
-                if (line.empty()) continue;
-
-                std::istringstream ss(line);
-                Order o; std::string tok;
-                std::getline(ss, tok, ','); o.orderId   = std::stoull(tok);
-                std::getline(ss, tok, ','); o.accountId = std::stoull(tok);
-                std::getline(ss, o.symbol,   ',');
-                std::getline(ss, tok,       ','); o.side     = static_cast<Side>(std::stoi(tok));
-                std::getline(ss, tok,       ','); o.type     = static_cast<OrderType>(std::stoi(tok));
-                std::getline(ss, tok,       ','); o.price    = std::stod(tok);
-                std::getline(ss, tok,       ','); o.quantity = std::stoull(tok);
-                std::getline(ss, tok);           o.timestamp= std::stoull(tok);
-
-                inQ.enqueue(o);
-            } })
-        .detach();
+    std::cout << "UDP order entry on port " << udpEntry->port() << "\n";
+    udpEntry->start([&]
+                    { placement.apply(ThreadRole::Ingest, orderEntry.threads()); });
   }
+  orderEntry.start([&](size_t k)
+                   { placement.apply(ThreadRole::Ingest, k); });
+  orderEntry.join();
 
-  engThread.join();
+  for (auto &t : engThreads)
+    t.join();
+  for (auto &t : pubThreads)
+    t.join();
   return 0;
 }
@@ -0,0 +1,83 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include "OrderParser.h"
+#include "SymbolDirectory.h"
+
+using namespace std;
+using clk = chrono::steady_clock;
+
+// Order-entry line parsing: OrderParser over one receive-sized buffer versus
+// the getline/istringstream/stoull path it replaced.
+// Usage: parser_benchmark [lines] [buffer bytes]
+static bool legacyParse(const string& line, SymbolDirectory& symbols, Order& o) {
+    try {
+        istringstream ss(line);
+        string tok;
+        getline(ss, tok, ','); o.orderId   = stoull(tok);
+        getline(ss, tok, ','); o.accountId = stoull(tok);
+        getline(ss, tok, ','); o.symbol    = symbols.intern(tok);
+        getline(ss, tok, ','); o.side      = static_cast<Side>(stoi(tok));
+        getline(ss, tok, ','); o.type      = static_cast<OrderType>(stoi(tok));
+        getline(ss, tok, ','); o.price     = toTicks(stod(tok), symbols.tickSize(o.symbol));
+        getline(ss, tok, ','); o.quantity  = stoull(tok);
+        getline(ss, tok);      o.timestamp = stoull(tok);
+    } catch (const exception&) {
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    const size_t N     = (argc>1 ? stoull(argv[1]) : 1'000'000);
+    const size_t chunk = (argc>2 ? stoull(argv[2]) : 4096);
+
+    const char* names[] = {"AAPL", "MSFT", "GOOG", "AMZN", "TSLA", "NVDA", "META", "BRK.A"};
+    mt19937_64 rng(42);
+    uniform_int_distribution<int> sym(0, 7), side(0, 1), cents(0, 99);
+    uniform_int_distribution<int> dollars(50, 500), qty(1, 1000);
+    string text;
+    for (size_t i = 0; i < N; ++i) {
+        int c = cents(rng);
+        text += to_string(i + 1) + ",17," + names[sym(rng)] + ',' + to_string(side(rng)) + ",0," +
+                to_string(dollars(rng)) + (c < 10 ? ".0" : ".") + to_string(c) +
+                ',' + to_string(qty(rng)) + ",1650000000000\n";
+    }
+    cout << N << " lines, " << text.size() / N << " bytes each, " << chunk << "-byte reads\n";
+
+    SymbolDirectory symbols;
+    uint64_t checksum = 0;
+    {
+        // Feed the parser one receive buffer at a time, carrying partial
+        // lines over the way the order-entry server does.
+        OrderParser parser(symbols);
+        string buf;
+        size_t parsed = 0;
+        auto t0 = clk::now();
+        for (size_t pos = 0; pos < text.size(); pos += chunk) {
+            buf.append(text, pos, chunk);
+            size_t used = parser.parseLines(buf,
+                [&](const Order& o) { checksum += o.price; ++parsed; return true; },
+                [](ParseError, const Order&) {});
+            buf.erase(0, used);
+        }
+        double ns = chrono::duration<double, nano>(clk::now() - t0).count();
+        cout << "OrderParser:   " << ns / parsed << " ns/order (" << parsed << " parsed)\n";
+    }
+    {
+        istringstream in(text);
+        string line;
+        Order o{};
+        size_t parsed = 0;
+        auto t0 = clk::now();
+        while (getline(in, line))
+            if (legacyParse(line, symbols, o)) { checksum -= o.price; ++parsed; }
+        double ns = chrono::duration<double, nano>(clk::now() - t0).count();
+        cout << "istringstream: " << ns / parsed << " ns/order (" << parsed << " parsed)\n";
+    }
+    // Both paths produce the same ticks, so this nets out to zero.
+    cout << "checksum " << checksum << "\n";
+}
@@ -0,0 +1,95 @@
+#include <iostream>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <boost/asio.hpp>
+#include "BinaryProtocol.h"
+#include "OrderEntryServer.h"
+#include "OrderParser.h"
+#include "ShardedEngine.h"
+
+using namespace std;
+using clk = chrono::steady_clock;
+using tcp = boost::asio::ip::tcp;
+
+// CSV versus binary order entry: decode cost alone, then end to end over
+// loopback through OrderEntryServer into one shard's session lane.
+// Usage: protocol_benchmark [orders]
+static Order makeOrder(uint64_t id, SymbolId symbol) {
+    return {id, 17, symbol, id % 2 ? Side::SELL : Side::BUY, OrderType::LIMIT,
+            Price(15000 + id % 100), 1 + id % 500, 1650000000000 + id};
+}
+
+static string csvLine(const Order& o, const SymbolDirectory& symbols) {
+    return to_string(o.orderId) + ',' + to_string(o.accountId) + ',' + symbols.name(o.symbol) + ',' +
+           to_string(int(o.side)) + ",0," + to_string(o.price / 100) + '.' +
+           (o.price % 100 < 10 ? "0" : "") + to_string(o.price % 100) + ',' +
+           to_string(o.quantity) + ',' + to_string(o.timestamp) + '\n';
+}
+
+static double endToEnd(ShardedEngine& engines, unsigned short port, const string& wire, size_t N) {
+    thread client([&] {
+        boost::asio::io_context ioc;
+        tcp::socket s(ioc);
+        s.connect({boost::asio::ip::address_v4::loopback(), port});
+        boost::asio::write(s, boost::asio::buffer(wire));
+        char byte;
+        boost::system::error_code ec;
+        boost::asio::read(s, boost::asio::buffer(&byte, 1), ec); // hold open until the server is done
+    });
+    vector<Order> batch(256);
+    size_t seen = 0;
+    auto t0 = clk::now();
+    while (seen < N)
+        seen += engines.drain(0, batch.data(), batch.size());
+    double secs = chrono::duration<double>(clk::now() - t0).count();
+    client.detach();
+    return N / secs;
+}
+
+int main(int argc, char* argv[]) {
+    const size_t N = (argc>1 ? stoull(argv[1]) : 1'000'000);
+
+    auto symbols = make_shared<SymbolDirectory>();
+    const SymbolId AAPL = symbols->intern("AAPL");
+    string csv, binary;
+    for (size_t i = 1; i <= N; ++i) {
+        Order o = makeOrder(i, AAPL);
+        csv += csvLine(o, *symbols);
+        encodeOrder(o, binary);
+    }
+    cout << N << " orders: CSV " << double(csv.size()) / N << " bytes/order, binary "
+         << double(binary.size()) / N << " bytes/order\n";
+
+    uint64_t checksum = 0;
+    {
+        OrderParser parser(*symbols);
+        auto t0 = clk::now();
+        parser.parseLines(csv, [&](const Order& o) { checksum += o.price; return true; },
+                          [](ParseError, const Order&) {});
+        double ns = chrono::duration<double, nano>(clk::now() - t0).count();
+        cout << "decode CSV:    " << ns / N << " ns/order\n";
+    }
+    {
+        Order o;
+        size_t used = 0;
+        BinaryReject reason;
+        auto t0 = clk::now();
+        for (size_t pos = 0; pos < binary.size(); pos += used)
+            if (decodeMessage(binary.data() + pos, binary.size() - pos, o, used, reason) == DecodeStatus::Ok)
+                checksum -= o.price;
+        double ns = chrono::duration<double, nano>(clk::now() - t0).count();
+        cout << "decode binary: " << ns / N << " ns/order (checksum " << checksum << ")\n";
+    }
+
+    IngressConfig ingress;
+    ingress.laneCapacity = 1u << 16;
+    ShardedEngine engines(1, symbols, PoolConfig{}, WaitMode::Spin, ingress);
+    OrderEntryServer server(engines, 0, 1);
+    unsigned short binaryPort = server.addListener(0, WireFormat::Binary);
+    server.start();
+    cout << "end to end CSV:    " << endToEnd(engines, server.port(), csv, N) << " orders/s\n";
+    cout << "end to end binary: " << endToEnd(engines, binaryPort, binary, N) << " orders/s\n";
+    server.stop();
+}
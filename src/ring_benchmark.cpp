@@ -0,0 +1,90 @@
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <string>
+#include <concurrentqueue.h>
+#include "Histogram.h"
+#include "Order.h"
+#include "SequencedRing.h"
+
+using namespace std;
+using clk = chrono::steady_clock;
+
+// Engine input paths head to head: P producer threads, one consumer.
+// Usage: ring_benchmark [orders] [producers] [capacity]
+static uint64_t nowNs() {
+    return chrono::duration_cast<chrono::nanoseconds>(clk::now().time_since_epoch()).count();
+}
+
+static Order makeOrder(uint64_t id) {
+    Order o;
+    o.orderId   = id;
+    o.accountId = 1;
+    o.symbol    = 0;
+    o.side      = Side::BUY;
+    o.type      = OrderType::LIMIT;
+    o.price     = 10000;
+    o.quantity  = 1;
+    o.timestamp = nowNs();   // enqueue time, for hand-off latency
+    return o;
+}
+
+template <class Push, class Pop>
+static void run(const string& name, size_t N, size_t P, Push push, Pop pop) {
+    Histogram latency;
+    atomic<bool> go{false};
+    vector<thread> producers;
+    for (size_t p = 0; p < P; ++p) {
+        producers.emplace_back([&, p] {
+            while (!go.load(memory_order_acquire)) {}
+            for (size_t i = p; i < N; i += P)
+                push(makeOrder(i + 1));
+        });
+    }
+
+    auto start = clk::now();
+    go.store(true, memory_order_release);
+    size_t seen = 0;
+    while (seen < N) {
+        seen += pop([&](const Order& o) { latency.record(nowNs() - o.timestamp); });
+    }
+    double secs = chrono::duration<double>(clk::now() - start).count();
+    for (auto& t : producers)
+        t.join();
+
+    cout << name << ": " << double(N) / secs << " orders/s, hand-off p50 = "
+         << latency.percentile(0.5) << " ns, p99 = " << latency.percentile(0.99) << " ns\n";
+}
+
+int main(int argc, char* argv[]) {
+    const size_t N        = (argc>1 ? stoull(argv[1]) : 2'000'000);
+    const size_t P        = (argc>2 ? stoull(argv[2]) : 2);
+    const size_t capacity = (argc>3 ? stoull(argv[3]) : 1u << 16);
+    cout << N << " orders from " << P << " producers\n";
+
+    {
+        moodycamel::ConcurrentQueue<Order> q;
+        vector<Order> batch(64);
+        run("ConcurrentQueue", N, P,
+            [&](const Order& o) { q.enqueue(o); },
+            [&](auto f) {
+                size_t n = q.try_dequeue_bulk(batch.begin(), batch.size());
+                for (size_t i = 0; i < n; ++i)
+                    f(batch[i]);
+                return n;
+            });
+    }
+    {
+        SequencedRing<Order> ring(capacity);
+        run("SequencedRing  ", N, P,
+            [&](const Order& o) {
+                int64_t seq = ring.claim();
+                ring[seq] = o;
+                ring.publish(seq);
+            },
+            [&](auto f) { return ring.poll(f, 64); });
+    }
+    return 0;
+}
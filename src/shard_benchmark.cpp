@@ -0,0 +1,68 @@
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <string>
+#include "ShardedEngine.h"
+
+using namespace std;
+using clk = chrono::high_resolution_clock;
+
+// Multi-symbol flow through N engine shards, one thread each.
+// Usage: shard_benchmark [orders] [shards] [symbols]
+int main(int argc, char* argv[]) {
+    const size_t N       = (argc>1 ? stoull(argv[1]) : 2'000'000);
+    const size_t shards  = (argc>2 ? stoull(argv[2]) : thread::hardware_concurrency());
+    const size_t symCount= (argc>3 ? stoull(argv[3]) : 64);
+
+    auto symbols = make_shared<SymbolDirectory>();
+    for (size_t s = 0; s < symCount; ++s)
+        symbols->setShard("SYM" + to_string(s), int(s));   // round-robin pins
+    ShardedEngine engines(shards, symbols);
+
+    vector<Order> orders;
+    orders.reserve(N);
+    for (size_t i = 0; i < N; ++i) {
+        Order o;
+        o.orderId   = i+1;
+        o.accountId = 1;
+        o.symbol    = SymbolId(i % symCount);
+        o.side      = ((i/symCount)%2==0 ? Side::BUY : Side::SELL);
+        o.type      = OrderType::LIMIT;
+        o.price     = 10000 + static_cast<Price>((i/symCount)%100);
+        o.quantity  = 1;
+        o.timestamp = i;
+        orders.push_back(o);
+    }
+
+    // Preload the queues so the run measures matching, not the producer.
+    for (auto& o : orders)
+        engines.submit(o);
+
+    atomic<bool> go{false};
+    vector<thread> workers;
+    for (size_t k = 0; k < engines.size(); ++k) {
+        workers.emplace_back([&, k] {
+            while (!go.load(memory_order_acquire)) {}
+            vector<Trade> trades;
+            trades.reserve(1024);
+            Order o;
+            while (engines.queue(k).try_dequeue(o)) {
+                trades.clear();
+                engines.engine(k).onNewOrder(o, trades);
+            }
+        });
+    }
+
+    auto start = clk::now();
+    go.store(true, memory_order_release);
+    for (auto& w : workers)
+        w.join();
+    double secs = chrono::duration<double>(clk::now() - start).count();
+
+    cout << "Ran " << N << " orders over " << symCount << " symbols on "
+         << engines.size() << " shards in " << secs << " s\n";
+    cout << " Throughput = " << double(N) / secs << " orders/s\n";
+    return 0;
+}
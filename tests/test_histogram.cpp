@@ -0,0 +1,21 @@
+#include "catch.hpp"
+#include "../src/Histogram.h"
+
+TEST_CASE("Histogram percentiles stay within a bucket of the truth", "[Histogram]") {
+    Histogram h;
+    REQUIRE(h.percentile(0.5) == 0);
+
+    for (uint64_t v = 1; v <= 1000; ++v)
+        h.record(v);
+    REQUIRE(h.count() == 1000);
+    REQUIRE(h.max() == 1000);
+    REQUIRE(h.mean() == Approx(500.5));
+    REQUIRE(h.percentile(0.5) >= 500);
+    REQUIRE(h.percentile(0.5) <= 625);
+    REQUIRE(h.percentile(0.99) >= 990);
+    REQUIRE(h.percentile(1.0) == 1000);
+
+    h.reset();
+    h.record(3);
+    REQUIRE(h.percentile(0.99) == 3); // small values are exact
+}
@@ -0,0 +1,64 @@
+#include "catch.hpp"
+#include "../src/MatchingEngine.h"
+#include <thread>
+
+TEST_CASE("Engine publishes depth and fills into market views", "[MarketView]") {
+    MatchingEngine eng;
+    const SymbolId TSLA = eng.symbols().intern("TSLA");
+    MarketViews views(eng.symbols().capacity());
+    BookView view;
+    REQUIRE(views.read(TSLA, view) == 0);
+
+    eng.onNewOrder({1,1,TSLA,Side::BUY,OrderType::LIMIT,19900,5,0});
+    eng.onNewOrder({2,2,TSLA,Side::SELL,OrderType::LIMIT,20000,3,1});
+    eng.onNewOrder({3,2,TSLA,Side::SELL,OrderType::LIMIT,20100,4,2});
+    eng.publishViews(views);
+
+    REQUIRE(views.read(TSLA, view) == 1);
+    REQUIRE(view.bidCount == 1);
+    REQUIRE(view.askCount == 2);
+    REQUIRE(view.asks[0].price == 20000);
+    REQUIRE(view.asks[1].quantity == 4);
+    REQUIRE(view.recentTrades(10).empty());
+
+    eng.onNewOrder({4,1,TSLA,Side::BUY,OrderType::MARKET,0,5,3});
+    REQUIRE(views.read(TSLA, view) == 1); // nothing new until published
+    eng.publishViews(views);
+
+    REQUIRE(views.read(TSLA, view) == 2);
+    REQUIRE(view.askCount == 1);
+    REQUIRE(view.asks[0].quantity == 2);
+    auto fills = view.recentTrades(10);
+    REQUIRE(fills.size() == 2);
+    REQUIRE(fills[0].sellOrderId == 2);
+    REQUIRE(fills[1].sellOrderId == 3);
+    REQUIRE(view.recentTrades(1)[0].sellOrderId == 3);
+}
+
+TEST_CASE("Market view readers never see a torn view", "[MarketView]") {
+    MarketViews views(1);
+    const uint64_t rounds = 20000;
+    std::thread writer([&] {
+        for (uint64_t r = 1; r <= rounds; ++r) {
+            BookView& v = views.stage(0);
+            v.bidCount = BookView::kDepth;
+            for (auto& lvl : v.bids)
+                lvl = {Price(r), r, 1};
+            views.publish(0);
+        }
+    });
+
+    BookView view;
+    uint64_t torn = 0, last = 0;
+    while (last < rounds) {
+        uint64_t version = views.read(0, view);
+        if (version == 0)
+            continue;
+        for (const auto& lvl : view.bids)
+            torn += lvl.quantity != view.bids[0].quantity;
+        torn += view.bids[0].quantity != version; // version matches content
+        last = version;
+    }
+    writer.join();
+    REQUIRE(torn == 0);
+}
@@ -3,14 +3,106 @@
 
 TEST_CASE("Engine routes to OrderBook", "[MatchingEngine]") {
     MatchingEngine eng;
+    const SymbolId TSLA = eng.symbols().intern("TSLA");
 
-    Order sell{1,2,"TSLA",Side::SELL,OrderType::LIMIT,200.0,3,0};
+    Order sell{1,2,TSLA,Side::SELL,OrderType::LIMIT,20000,3,0};
     auto t0 = eng.onNewOrder(sell);
     REQUIRE(t0.empty());
 
-    Order buy{2,1,"TSLA",Side::BUY,OrderType::LIMIT,205.0,2,1};
+    Order buy{2,1,TSLA,Side::BUY,OrderType::LIMIT,20500,2,1};
     auto t1 = eng.onNewOrder(buy);
     REQUIRE(t1.size() == 1);
     REQUIRE(t1[0].tradeId == 1);
-    REQUIRE(t1[0].price   == 200.0);
+    REQUIRE(t1[0].price   == 20000);
+}
+
+TEST_CASE("Engine builds array books for configured symbols", "[MatchingEngine]") {
+    auto symbols = std::make_shared<SymbolDirectory>();
+    symbols->setBookType("TSLA", BookType::Array, LadderConfig{64, 4096});
+    const SymbolId TSLA = symbols->find("TSLA");
+    MatchingEngine eng(symbols);
+
+    eng.onNewOrder({1,2,TSLA,Side::BUY,OrderType::LIMIT,20000,3,0});
+    eng.onNewOrder({2,2,TSLA,Side::BUY,OrderType::LIMIT,19000,4,1});
+    auto bids = eng.snapshotBook(TSLA, 5);
+    REQUIRE(bids.size() == 2);
+    REQUIRE(bids[0].price == 20000);
+    REQUIRE(bids[1].price == 19000);
+
+    auto t = eng.onNewOrder({3,1,TSLA,Side::SELL,OrderType::MARKET,0,5,2});
+    REQUIRE(t.size() == 2);
+    REQUIRE(t[1].price == 19000);
+}
+
+TEST_CASE("Engine appends fills to a caller-owned buffer", "[MatchingEngine]") {
+    MatchingEngine eng;
+    const SymbolId TSLA = eng.symbols().intern("TSLA");
+    for (uint64_t i = 1; i <= 5; ++i)
+        eng.onNewOrder({i,2,TSLA,Side::SELL,OrderType::LIMIT,Price(20000 + i),1,i});
+
+    std::vector<Trade> fills;
+    fills.reserve(16);
+    const Trade *data = fills.data();
+    eng.onNewOrder({10,1,TSLA,Side::BUY,OrderType::MARKET,0,3,6}, fills);
+    eng.onNewOrder({11,1,TSLA,Side::BUY,OrderType::MARKET,0,2,7}, fills);
+
+    REQUIRE(fills.data() == data); // no reallocation
+    REQUIRE(fills.size() == 5);
+    for (size_t i = 0; i < fills.size(); ++i) {
+        REQUIRE(fills[i].tradeId == i + 1);
+        REQUIRE(fills[i].sellOrderId == i + 1);
+    }
+    REQUIRE(fills[4].buyOrderId == 11);
+
+    auto recent = eng.recentTrades(TSLA, 2);
+    REQUIRE(recent.size() == 2);
+    REQUIRE(recent[0].tradeId == 4);
+    REQUIRE(recent[1].tradeId == 5);
+    REQUIRE(eng.collectTrades().size() == 5);
+    REQUIRE(eng.collectTrades().empty());
+}
+
+TEST_CASE("Fills that leave the ring uncollected are counted", "[MatchingEngine]") {
+    MatchingEngine eng;
+    const SymbolId TSLA = eng.symbols().intern("TSLA");
+    MarketViews views(eng.symbols().capacity());
+    const uint64_t fills = MatchingEngine::kRecentTrades + 10;
+    eng.onNewOrder({1,1,TSLA,Side::SELL,OrderType::LIMIT,20000,fills,0});
+    for (uint64_t i = 0; i < fills; ++i)
+        eng.onNewOrder({2 + i,2,TSLA,Side::BUY,OrderType::LIMIT,20000,1,0});
+
+    auto collected = eng.collectTrades();
+    REQUIRE(collected.size() == MatchingEngine::kRecentTrades);
+    REQUIRE(collected.front().tradeId == 11);
+    REQUIRE(eng.lostTrades() == 10);
+    eng.publishViews(views);
+    REQUIRE(eng.unviewedTrades() == 10);
+
+    eng.onNewOrder({1,1,TSLA,Side::SELL,OrderType::LIMIT,20000,1,0});
+    eng.onNewOrder({9999,2,TSLA,Side::BUY,OrderType::LIMIT,20000,1,0});
+    REQUIRE(eng.collectTrades().size() == 1);
+    eng.publishViews(views);
+    REQUIRE(eng.lostTrades() == 10);
+    REQUIRE(eng.unviewedTrades() == 10);
+}
+
+TEST_CASE("Engine stamps all fills of one order with one event time", "[MatchingEngine]") {
+    MatchingEngine eng;
+    auto clock = std::make_shared<LogicalClock>(1000, 10);
+    eng.setClock(clock);
+    const SymbolId TSLA = eng.symbols().intern("TSLA");
+    for (uint64_t i = 1; i <= 3; ++i)
+        eng.onNewOrder({i,2,TSLA,Side::SELL,OrderType::LIMIT,Price(20000 + i),1,0});
+
+    auto fills = eng.onNewOrder({10,1,TSLA,Side::BUY,OrderType::MARKET,0,3,0});
+    REQUIRE(fills.size() == 3);
+    for (const auto& t : fills)
+        REQUIRE(t.timestamp == 1030);
+
+    fills = eng.onNewOrder({11,1,TSLA,Side::SELL,OrderType::LIMIT,20000,1,0});
+    REQUIRE(fills.empty());
+    clock->set(5);
+    fills = eng.onNewOrder({12,1,TSLA,Side::BUY,OrderType::LIMIT,20000,1,0});
+    REQUIRE(fills.size() == 1);
+    REQUIRE(fills[0].timestamp == 5);
 }
@@ -1,18 +1,56 @@
 #define CATCH_CONFIG_MAIN
 #include "catch.hpp"
 #include "../src/Order.h"
+#include "../src/SymbolDirectory.h"
 
 TEST_CASE("Order struct initialization", "[order]")
 {
   // orderId, accountId, symbol, side, type, price, quantity, timestamp
-  Order o{1, 42, "AAPL", Side::BUY, OrderType::LIMIT, 150.0, 10, 0};
+  Order o{1, 42, 7, Side::BUY, OrderType::LIMIT, 15000, 10, 0};
 
   REQUIRE(o.orderId == 1);
   REQUIRE(o.accountId == 42);
-  REQUIRE(o.symbol == "AAPL");
+  REQUIRE(o.symbol == 7);
   REQUIRE(o.side == Side::BUY);
   REQUIRE(o.type == OrderType::LIMIT);
-  REQUIRE(o.price == 150.0);
+  REQUIRE(o.price == 15000);
   REQUIRE(o.quantity == 10);
   REQUIRE(o.timestamp == 0);
 }
+
+TEST_CASE("Prices convert to and from integer ticks", "[order]")
+{
+  REQUIRE(toTicks(150.01, 0.01) == 15001);
+  REQUIRE(toTicks(0.1 + 0.2, 0.1) == 3); // rounding noise collapses onto one tick
+  REQUIRE(toTicks(100.25, 0.25) == 401);
+  REQUIRE(fromTicks(15001, 0.01) == 150.01);
+  REQUIRE(fromTicks(401, 0.25) == 100.25);
+}
+
+TEST_CASE("Symbol directory resolves per-symbol tick sizes", "[order]")
+{
+  SymbolDirectory symbols(0.01);
+  symbols.loadTickSizes("BRK.A:1,ES:0.25");
+
+  REQUIRE(symbols.tickSize(symbols.intern("AAPL")) == 0.01);
+  REQUIRE(symbols.tickSize(symbols.intern("BRK.A")) == 1.0);
+  REQUIRE(symbols.tickSize(symbols.intern("ES")) == 0.25);
+}
+
+TEST_CASE("Symbol directory interns names to dense ids", "[order]")
+{
+  SymbolDirectory symbols(0.01, 2);
+  SymbolId aapl = symbols.intern("AAPL");
+  SymbolId msft = symbols.intern("MSFT");
+
+  REQUIRE(aapl == 0);
+  REQUIRE(msft == 1);
+  REQUIRE(symbols.intern("AAPL") == aapl);
+  REQUIRE(symbols.find("MSFT") == msft);
+  REQUIRE(symbols.find("TSLA") == SymbolDirectory::kInvalid);
+  REQUIRE(symbols.name(msft) == "MSFT");
+
+  // Capacity is fixed so readers never see the table move.
+  REQUIRE(symbols.intern("TSLA") == SymbolDirectory::kInvalid);
+  REQUIRE(symbols.size() == 2);
+}
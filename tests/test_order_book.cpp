@@ -1,46 +1,302 @@
 #include "catch.hpp"
 #include "../src/OrderBook.h"
+#include "../src/TickBitmap.h"
+#include <limits>
 
-TEST_CASE("Single limit order rests without match", "[OrderBook]") {
-    OrderBook book("AAPL");
-    Order o1{1, 1, "AAPL", Side::BUY, OrderType::LIMIT, 100.0, 5, 0};
+static const SymbolId AAPL = 0;
+
+TEMPLATE_TEST_CASE("Single limit order rests without match", "[OrderBook]", OrderBook, ArrayOrderBook) {
+    TestType book(AAPL);
+    Order o1{1, 1, AAPL, Side::BUY, OrderType::LIMIT, 10000, 5, 0};
     auto trades = book.addOrder(o1);
     REQUIRE(trades.empty());
-    REQUIRE(book.bestBid() == 100.0);
-    REQUIRE(book.bestAsk() == 0.0);
+    REQUIRE(book.bestBid() == 10000);
+    REQUIRE(book.bestAsk() == 0);
 }
 
-TEST_CASE("Crossing limit orders generate a trade", "[OrderBook]") {
-    OrderBook book("AAPL");
-    Order sell{1, 2, "AAPL", Side::SELL, OrderType::LIMIT, 101.0, 3, 0};
+TEMPLATE_TEST_CASE("Crossing limit orders generate a trade", "[OrderBook]", OrderBook, ArrayOrderBook) {
+    TestType book(AAPL);
+    Order sell{1, 2, AAPL, Side::SELL, OrderType::LIMIT, 10100, 3, 0};
     book.addOrder(sell);
 
-    Order buy{2, 1, "AAPL", Side::BUY, OrderType::LIMIT, 102.0, 2, 1};
+    Order buy{2, 1, AAPL, Side::BUY, OrderType::LIMIT, 10200, 2, 1};
     auto trades = book.addOrder(buy);
 
     REQUIRE(trades.size() == 1);
     REQUIRE(trades[0].quantity == 2);
-    REQUIRE(trades[0].price    == 101.0);
+    REQUIRE(trades[0].price    == 10100);
 
-    REQUIRE(book.bestAsk() == 101.0);
+    REQUIRE(book.bestAsk() == 10100);
 }
 
-TEST_CASE("Market order sweeps multiple levels", "[OrderBook]") {
-    OrderBook book("AAPL");
-    book.addOrder({1,3,"AAPL",Side::SELL,OrderType::LIMIT,100.0,2,0});
-    book.addOrder({2,4,"AAPL",Side::SELL,OrderType::LIMIT,102.0,5,1});
+TEMPLATE_TEST_CASE("Market order sweeps multiple levels", "[OrderBook]", OrderBook, ArrayOrderBook) {
+    TestType book(AAPL);
+    book.addOrder({1,3,AAPL,Side::SELL,OrderType::LIMIT,10000,2,0});
+    book.addOrder({2,4,AAPL,Side::SELL,OrderType::LIMIT,10200,5,1});
 
-    auto trades = book.addOrder({3,5,"AAPL",Side::BUY,OrderType::MARKET,0.0,6,2});
+    auto trades = book.addOrder({3,5,AAPL,Side::BUY,OrderType::MARKET,0,6,2});
     REQUIRE(trades.size() == 2);
     REQUIRE(trades[0].quantity == 2);
-    REQUIRE(trades[0].price    == 100.0);
+    REQUIRE(trades[0].price    == 10000);
     REQUIRE(trades[1].quantity == 4);
-    REQUIRE(trades[1].price    == 102.0);
+    REQUIRE(trades[1].price    == 10200);
+}
+
+TEMPLATE_TEST_CASE("Cancel resting order", "[OrderBook]", OrderBook, ArrayOrderBook) {
+    TestType book(AAPL);
+    book.addOrder({1,1,AAPL,Side::BUY,OrderType::LIMIT,9900,10,0});
+    book.addOrder({1,0,AAPL,Side::BUY,OrderType::CANCEL,0,0,1});
+    REQUIRE(book.bestBid() == 0);
+}
+
+TEST_CASE("Array ladder recenters when price drifts", "[OrderBook]") {
+    ArrayOrderBook book(AAPL, 0.01, LadderConfig{16, 1024});
+    book.addOrder({1,1,AAPL,Side::BUY,OrderType::LIMIT,10000,1,0});
+    book.addOrder({2,1,AAPL,Side::BUY,OrderType::LIMIT,10030,2,1});
+    book.addOrder({3,1,AAPL,Side::BUY,OrderType::LIMIT,9970,3,2});
+    REQUIRE(book.bestBid() == 10030);
+
+    auto bids = book.getBids(10);
+    REQUIRE(bids.size() == 3);
+    REQUIRE(bids[0].price == 10030);
+    REQUIRE(bids[1].price == 10000);
+    REQUIRE(bids[2].price == 9970);
+    REQUIRE(bids[2].quantity == 3);
+
+    auto trades = book.addOrder({4,2,AAPL,Side::SELL,OrderType::LIMIT,9990,3,3});
+    REQUIRE(trades.size() == 2);
+    REQUIRE(trades[0].price == 10030);
+    REQUIRE(trades[1].price == 10000);
+    REQUIRE(book.bestBid() == 9970);
+}
+
+TEST_CASE("Array ladder keeps out-of-window levels in price order", "[OrderBook]") {
+    // Window may never exceed 8 ticks, so 500 and 1 cannot share it with 100.
+    ArrayOrderBook book(AAPL, 0.01, LadderConfig{8, 8});
+    book.addOrder({1,1,AAPL,Side::SELL,OrderType::LIMIT,100,1,0});
+    book.addOrder({2,1,AAPL,Side::SELL,OrderType::LIMIT,500,2,1});
+    book.addOrder({3,1,AAPL,Side::SELL,OrderType::LIMIT,1,3,2});
+    book.addOrder({4,1,AAPL,Side::SELL,OrderType::LIMIT,102,4,3});
+    REQUIRE(book.bestAsk() == 1);
+
+    auto asks = book.getAsks(10);
+    REQUIRE(asks.size() == 4);
+    REQUIRE(asks[0].price == 1);
+    REQUIRE(asks[1].price == 100);
+    REQUIRE(asks[2].price == 102);
+    REQUIRE(asks[3].price == 500);
+
+    book.cancelOrder(3);
+    book.cancelOrder(1);
+    book.cancelOrder(4);
+    REQUIRE(book.bestAsk() == 500);
+
+    auto trades = book.addOrder({5,2,AAPL,Side::BUY,OrderType::MARKET,0,2,4});
+    REQUIRE(trades.size() == 1);
+    REQUIRE(trades[0].price == 500);
+    REQUIRE(book.bestAsk() == 0);
 }
 
-TEST_CASE("Cancel resting order", "[OrderBook]") {
-    OrderBook book("AAPL");
-    book.addOrder({1,1,"AAPL",Side::BUY,OrderType::LIMIT,99.0,10,0});
-    book.addOrder({1,0,"AAPL",Side::BUY,OrderType::CANCEL,0.0,0,1});
-    REQUIRE(book.bestBid() == 0.0);
+TEST_CASE("Array ladder handles prices at the ends of the tick range", "[OrderBook]") {
+    const Price lowest = std::numeric_limits<Price>::min();
+    const Price highest = std::numeric_limits<Price>::max();
+    ArrayOrderBook book(AAPL, 0.01, LadderConfig{8, 16});
+    book.addOrder({1,1,AAPL,Side::SELL,OrderType::LIMIT,highest,1,0});
+    book.addOrder({2,1,AAPL,Side::SELL,OrderType::LIMIT,highest - 1,2,1});
+    book.addOrder({3,1,AAPL,Side::SELL,OrderType::LIMIT,100,3,2});
+    book.addOrder({4,1,AAPL,Side::BUY,OrderType::LIMIT,lowest,4,3});
+    book.addOrder({5,1,AAPL,Side::BUY,OrderType::LIMIT,lowest + 2,5,4});
+    book.addOrder({6,1,AAPL,Side::BUY,OrderType::LIMIT,50,6,5});
+
+    auto asks = book.getAsks(10);
+    REQUIRE(asks.size() == 3);
+    REQUIRE(asks[0].price == 100);
+    REQUIRE(asks[1].price == highest - 1);
+    REQUIRE(asks[2].price == highest);
+    auto bids = book.getBids(10);
+    REQUIRE(bids.size() == 3);
+    REQUIRE(bids[0].price == 50);
+    REQUIRE(bids[1].price == lowest + 2);
+    REQUIRE(bids[2].price == lowest);
+
+    // Emptying the near levels re-anchors the windows at the extremes.
+    book.cancelOrder(3);
+    book.cancelOrder(6);
+    REQUIRE(book.bestAsk() == highest - 1);
+    REQUIRE(book.bestBid() == lowest + 2);
+    book.addOrder({7,1,AAPL,Side::SELL,OrderType::LIMIT,highest - 3,7,6});
+    book.addOrder({8,1,AAPL,Side::BUY,OrderType::LIMIT,lowest + 1,8,7});
+    REQUIRE(book.bestAsk() == highest - 3);
+    REQUIRE(book.getBids(10).size() == 3);
+
+    auto trades = book.addOrder({9,2,AAPL,Side::BUY,OrderType::MARKET,0,10,8});
+    REQUIRE(trades.size() == 3);
+    REQUIRE(trades[2].price == highest);
+    REQUIRE(book.bestAsk() == 0);
+}
+
+TEMPLATE_TEST_CASE("Cancel inside a level keeps time priority of the rest", "[OrderBook]", OrderBook, ArrayOrderBook) {
+    TestType book(AAPL);
+    book.addOrder({1,1,AAPL,Side::SELL,OrderType::LIMIT,10000,1,0});
+    book.addOrder({2,2,AAPL,Side::SELL,OrderType::LIMIT,10000,2,1});
+    book.addOrder({3,3,AAPL,Side::SELL,OrderType::LIMIT,10000,3,2});
+    book.cancelOrder(2);
+
+    auto asks = book.getAsks(1);
+    REQUIRE(asks[0].quantity == 4);
+
+    auto trades = book.addOrder({4,4,AAPL,Side::BUY,OrderType::LIMIT,10000,4,3});
+    REQUIRE(trades.size() == 2);
+    REQUIRE(trades[0].sellOrderId == 1);
+    REQUIRE(trades[1].sellOrderId == 3);
+    REQUIRE(book.bestAsk() == 0);
+
+    // Filled orders are no longer resting, so cancelling them is a no-op.
+    book.addOrder({5,5,AAPL,Side::SELL,OrderType::LIMIT,10100,1,4});
+    book.cancelOrder(3);
+    REQUIRE(book.bestAsk() == 10100);
+}
+
+TEMPLATE_TEST_CASE("Level totals track adds, fills and cancels", "[OrderBook]", OrderBook, ArrayOrderBook) {
+    TestType book(AAPL);
+    book.addOrder({1,1,AAPL,Side::BUY,OrderType::LIMIT,10000,5,0});
+    book.addOrder({2,1,AAPL,Side::BUY,OrderType::LIMIT,10000,7,1});
+    book.addOrder({3,1,AAPL,Side::BUY,OrderType::LIMIT,9900,4,2});
+
+    auto bids = book.getBids(2);
+    REQUIRE(bids[0].quantity == 12);
+    REQUIRE(bids[0].orders == 2);
+    REQUIRE(bids[1].quantity == 4);
+    REQUIRE(bids[1].orders == 1);
+
+    book.addOrder({4,2,AAPL,Side::SELL,OrderType::LIMIT,10000,8,3});
+    bids = book.getBids(1);
+    REQUIRE(bids[0].quantity == 4);
+    REQUIRE(bids[0].orders == 1);
+
+    book.cancelOrder(2);
+    bids = book.getBids(1);
+    REQUIRE(bids[0].price == 9900);
+    REQUIRE(bids[0].orders == 1);
+
+    REQUIRE(book.fillableQuantity(Side::SELL, 9900, 10) == 4);
+    REQUIRE(book.fillableQuantity(Side::SELL, 9901, 10) == 0);
+    REQUIRE(book.fillableQuantity(Side::SELL, 9000, 3) == 3);
+}
+
+TEMPLATE_TEST_CASE("Resting orders are recycled through the book pools", "[OrderBook]", OrderBook, ArrayOrderBook) {
+    auto pools = std::make_shared<BookPools>(PoolConfig{64, 16, 16});
+    {
+        TestType book(AAPL, 0.01, LadderConfig{}, pools);
+        for (uint64_t i = 1; i <= 100; ++i)
+            book.addOrder({i,1,AAPL,Side::BUY,OrderType::LIMIT,Price(10000 + i % 7),1,i});
+        REQUIRE(pools->orders.slab().inUse() == 100);
+
+        for (uint64_t i = 1; i <= 50; ++i)
+            book.cancelOrder(i);
+        book.addOrder({200,2,AAPL,Side::SELL,OrderType::MARKET,0,20,0});
+        REQUIRE(pools->orders.slab().inUse() == 30);
+
+        // Freed nodes are reused before the pool grows again.
+        size_t capacity = pools->orders.slab().capacity();
+        for (uint64_t i = 300; i < 370; ++i)
+            book.addOrder({i,1,AAPL,Side::BUY,OrderType::LIMIT,10000,1,i});
+        REQUIRE(pools->orders.slab().capacity() == capacity);
+    }
+    REQUIRE(pools->orders.slab().inUse() == 0);
+    REQUIRE(pools->levels.inUse() == 0);
+    REQUIRE(pools->handles.inUse() == 0);
+}
+
+TEST_CASE("Tick bitmap finds neighbouring occupied ticks across levels", "[TickBitmap]") {
+    TickBitmap bits(300000); // three levels
+    REQUIRE_FALSE(bits.any());
+    REQUIRE(bits.findNext(0) == TickBitmap::npos);
+    REQUIRE(bits.findPrev(299999) == TickBitmap::npos);
+
+    bits.set(5);
+    bits.set(4096);
+    bits.set(262143);
+    bits.set(299999);
+    REQUIRE(bits.any());
+    REQUIRE(bits.findNext(0) == 5);
+    REQUIRE(bits.findNext(6) == 4096);
+    REQUIRE(bits.findNext(4097) == 262143);
+    REQUIRE(bits.findNext(262144) == 299999);
+    REQUIRE(bits.findPrev(299998) == 262143);
+    REQUIRE(bits.findPrev(262142) == 4096);
+    REQUIRE(bits.findPrev(4095) == 5);
+    REQUIRE(bits.findPrev(4) == TickBitmap::npos);
+
+    bits.clear(4096);
+    REQUIRE(bits.findNext(6) == 262143);
+    REQUIRE(bits.findPrev(262142) == 5);
+    bits.clear(5);
+    bits.clear(262143);
+    bits.clear(299999);
+    REQUIRE_FALSE(bits.any());
+}
+
+TEST_CASE("Array ladder skips wide gaps when the top level empties", "[OrderBook]") {
+    ArrayOrderBook book(AAPL, 0.01, LadderConfig{1u << 16, 1u << 16});
+    book.addOrder({1,1,AAPL,Side::BUY,OrderType::LIMIT,50000,1,0});
+    book.addOrder({2,1,AAPL,Side::BUY,OrderType::LIMIT,20000,1,1});
+    book.addOrder({3,1,AAPL,Side::BUY,OrderType::LIMIT,30000,1,2});
+    book.addOrder({4,1,AAPL,Side::SELL,OrderType::LIMIT,60000,1,3});
+    book.addOrder({5,1,AAPL,Side::SELL,OrderType::LIMIT,75000,1,4});
+
+    book.cancelOrder(1);
+    REQUIRE(book.bestBid() == 30000);
+    book.cancelOrder(3);
+    REQUIRE(book.bestBid() == 20000);
+
+    auto trades = book.addOrder({6,2,AAPL,Side::BUY,OrderType::MARKET,0,2,5});
+    REQUIRE(trades.size() == 2);
+    REQUIRE(trades[1].price == 75000);
+    REQUIRE(book.bestAsk() == 0);
+}
+
+TEMPLATE_TEST_CASE("Replace down in size keeps queue priority", "[OrderBook]", OrderBook, ArrayOrderBook) {
+    TestType book(AAPL);
+    book.addOrder({1,1,AAPL,Side::SELL,OrderType::LIMIT,10000,10,0});
+    book.addOrder({2,2,AAPL,Side::SELL,OrderType::LIMIT,10000,5,1});
+
+    // Side and account on a REPLACE are ignored; the resting order's are kept.
+    book.addOrder({1,0,AAPL,Side::BUY,OrderType::REPLACE,10000,4,2});
+    auto asks = book.getAsks(1);
+    REQUIRE(asks[0].quantity == 9);
+    REQUIRE(asks[0].orders == 2);
+
+    auto trades = book.addOrder({3,3,AAPL,Side::BUY,OrderType::LIMIT,10000,6,3});
+    REQUIRE(trades.size() == 2);
+    REQUIRE(trades[0].sellOrderId == 1);
+    REQUIRE(trades[0].quantity == 4);
+    REQUIRE(trades[1].sellOrderId == 2);
+    REQUIRE(trades[1].quantity == 2);
+}
+
+TEMPLATE_TEST_CASE("Replace up in size or price requeues the order", "[OrderBook]", OrderBook, ArrayOrderBook) {
+    TestType book(AAPL);
+    std::vector<Trade> trades;
+    book.addOrder({1,1,AAPL,Side::SELL,OrderType::LIMIT,10000,5,0});
+    book.addOrder({2,2,AAPL,Side::SELL,OrderType::LIMIT,10000,5,1});
+
+    REQUIRE(book.replaceOrder({1,0,AAPL,Side::SELL,OrderType::REPLACE,10000,6,2}, trades, 2));
+    trades = book.addOrder({3,3,AAPL,Side::BUY,OrderType::LIMIT,10000,1,3});
+    REQUIRE(trades[0].sellOrderId == 2);
+
+    // Moving the price through the opposite side matches straight away.
+    book.addOrder({4,4,AAPL,Side::BUY,OrderType::LIMIT,9900,3,4});
+    trades = book.addOrder({1,0,AAPL,Side::SELL,OrderType::REPLACE,9900,6,5});
+    REQUIRE(trades.size() == 1);
+    REQUIRE(trades[0].buyOrderId == 4);
+    REQUIRE(trades[0].sellOrderId == 1);
+    REQUIRE(trades[0].price == 9900);
+    REQUIRE(book.bestAsk() == 9900);
+    REQUIRE(book.getAsks(1)[0].quantity == 3);
+
+    trades.clear();
+    REQUIRE_FALSE(book.replaceOrder({99,0,AAPL,Side::SELL,OrderType::REPLACE,9900,1,6}, trades, 6));
+    REQUIRE(book.replaceOrder({1,0,AAPL,Side::SELL,OrderType::REPLACE,9900,0,7}, trades, 7));
+    REQUIRE(book.bestAsk() == 10000);
 }
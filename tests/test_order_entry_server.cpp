@@ -0,0 +1,463 @@
+#include "catch.hpp"
+#include "../src/BinaryProtocol.h"
+#include "../src/OrderEntryServer.h"
+#include "../src/UdpOrderListener.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace {
+
+using tcp = boost::asio::ip::tcp;
+
+// Drain shard 0 until `want` orders have arrived or two seconds pass.
+size_t drainUntil(ShardedEngine& engines, size_t want) {
+    Order batch[64];
+    size_t seen = 0;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (seen < want && std::chrono::steady_clock::now() < deadline) {
+        size_t n = engines.drain(0, batch, 64);
+        seen += n;
+        if (n == 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return seen;
+}
+
+template <class Pred>
+bool eventually(Pred pred) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (!pred() && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    return pred();
+}
+
+// Stand-in for shard 0's engine thread: matches and reports until destroyed.
+class EngineThread {
+public:
+    explicit EngineThread(ShardedEngine& engines)
+        : engines_(engines), thread_([this] { run(); }) {}
+    ~EngineThread() {
+        running_ = false;
+        thread_.join();
+    }
+
+private:
+    void run() {
+        Order batch[64];
+        std::vector<Trade> trades;
+        while (running_) {
+            size_t n = engines_.drain(0, batch, 64);
+            trades.clear();
+            for (size_t i = 0; i < n; ++i) {
+                size_t first = trades.size();
+                bool applied = engines_.engine(0).onNewOrder(batch[i], trades);
+                engines_.report(0, batch[i], applied, trades.data() + first, trades.size() - first);
+            }
+            engines_.flushReports(0);
+            if (n == 0)
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+
+    ShardedEngine& engines_;
+    std::atomic<bool> running_{true};
+    std::thread thread_;
+};
+
+} // namespace
+
+TEST_CASE("Order entry serves many connections on a fixed thread pool", "[OrderEntryServer]") {
+    auto symbols = std::make_shared<SymbolDirectory>();
+    ShardedEngine engines(1, symbols);
+    OrderEntryServer server(engines, 0, 2);
+    server.start();
+
+    boost::asio::io_context ioc;
+    std::vector<tcp::socket> clients;
+    for (int i = 0; i < 100; ++i) {
+        clients.emplace_back(ioc);
+        clients.back().connect({boost::asio::ip::address_v4::loopback(), server.port()});
+        std::string lines = std::to_string(2 * i + 1) + ",1,AAPL,0,0,100.00,1,0\n" +
+                            std::to_string(2 * i + 2) + ",1,AAPL,1,0,101.00,1,0\n";
+        boost::asio::write(clients.back(), boost::asio::buffer(lines));
+    }
+
+    REQUIRE(drainUntil(engines, 200) == 200);
+    REQUIRE(server.connections() == 100);
+    REQUIRE(server.threads() == 2);
+
+    clients.clear();
+    REQUIRE(eventually([&] { return server.connections() == 0; }));
+}
+
+TEST_CASE("Order entry answers rejects and holds back when full", "[OrderEntryServer]") {
+    auto symbols = std::make_shared<SymbolDirectory>();
+    IngressConfig ingress;
+    ingress.highWater = 1;
+    boost::asio::io_context ioc;
+
+    SECTION("reject") {
+        ingress.overload = OverloadPolicy::Reject;
+        ShardedEngine engines(1, symbols, PoolConfig{}, WaitMode::Block, ingress);
+        OrderEntryServer server(engines, 0, 1);
+        server.start();
+
+        tcp::socket client(ioc);
+        client.connect({boost::asio::ip::address_v4::loopback(), server.port()});
+        boost::asio::write(client, boost::asio::buffer(std::string(
+            "1,1,AAPL,0,0,100.00,1,0\n2,1,AAPL,0,0,100.00,1,0\n3,1,AAPL,0,0,100.00,1,0\n")));
+
+        boost::asio::streambuf reply;
+        boost::asio::read_until(client, reply, "REJECT,3,OVERLOADED\n");
+        std::string text(boost::asio::buffers_begin(reply.data()), boost::asio::buffers_end(reply.data()));
+        REQUIRE(text == "REJECT,2,OVERLOADED\nREJECT,3,OVERLOADED\n");
+        REQUIRE(engines.rejected(0) == 2);
+    }
+
+    SECTION("backpressure") {
+        ShardedEngine engines(1, symbols, PoolConfig{}, WaitMode::Block, ingress);
+        OrderEntryServer server(engines, 0, 1);
+        server.start();
+
+        tcp::socket client(ioc);
+        client.connect({boost::asio::ip::address_v4::loopback(), server.port()});
+        boost::asio::write(client, boost::asio::buffer(std::string(
+            "1,1,AAPL,0,0,100.00,1,0\n2,1,AAPL,0,0,100.00,1,0\n3,1,AAPL,0,0,100.00,1,0\n")));
+
+        REQUIRE(eventually([&] { return engines.depth(0) == 1; }));
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        REQUIRE(engines.depth(0) == 1);
+        REQUIRE(drainUntil(engines, 3) == 3);
+        REQUIRE(engines.rejected(0) == 0);
+    }
+}
+
+TEST_CASE("Clients that never read their rejects are disconnected", "[OrderEntryServer]") {
+    auto symbols = std::make_shared<SymbolDirectory>();
+    IngressConfig ingress;
+    ingress.highWater = 1;
+    ingress.overload = OverloadPolicy::Reject;
+    ShardedEngine engines(1, symbols, PoolConfig{}, WaitMode::Block, ingress);
+    OrderEntryServer server(engines, 0, 1, 16 * 1024);
+    server.start();
+
+    boost::asio::io_context ioc;
+    tcp::socket client(ioc);
+    client.open(tcp::v4());
+    client.set_option(boost::asio::socket_base::receive_buffer_size(4096));
+    client.connect({boost::asio::ip::address_v4::loopback(), server.port()});
+    REQUIRE(eventually([&] { return server.connections() == 1; }));
+
+    // Nothing drains the shard, so every order after the first is refused:
+    // about 10 MB of rejects, more than the kernel buffers on either side.
+    std::string lines;
+    for (int i = 1; i <= 400000; ++i)
+        lines += std::to_string(i) + ",1,AAPL,0,0,100.00,1,0\n";
+    boost::system::error_code ec;
+    boost::asio::write(client, boost::asio::buffer(lines), ec);
+    REQUIRE(eventually([&] { return server.connections() == 0; }));
+    REQUIRE(engines.rejected(0) < 399999);
+}
+
+TEST_CASE("Binary messages round-trip through the codec", "[OrderEntryServer]") {
+    std::string wire;
+    encodeOrder({1,7,3,Side::SELL,OrderType::LIMIT,15025,10,99}, wire);
+    encodeOrder({2,7,3,Side::BUY,OrderType::MARKET,0,5,100}, wire);
+    encodeOrder({1,7,3,Side::BUY,OrderType::CANCEL,0,0,101}, wire);
+    encodeOrder({2,7,3,Side::BUY,OrderType::REPLACE,15000,4,102}, wire);
+    REQUIRE(wire.size() == 32 + 32 + 24 + 32);
+    REQUIRE_FALSE(encodeOrder({3,7,3,Side::BUY,OrderType::LIMIT,15000,uint64_t{1} << 32,103}, wire));
+    REQUIRE_FALSE(encodeOrder({2,7,3,Side::BUY,OrderType::REPLACE,15000,uint64_t{1} << 32,104}, wire));
+    REQUIRE_FALSE(encodeOrder({3,uint64_t{1} << 32,3,Side::BUY,OrderType::LIMIT,15000,1,105}, wire));
+    REQUIRE_FALSE(encodeOrder({3,7,1 << 16,Side::BUY,OrderType::LIMIT,15000,1,106}, wire));
+    REQUIRE(wire.size() == 32 + 32 + 24 + 32);
+
+    Order o;
+    size_t used = 0;
+    BinaryReject reason{};
+    REQUIRE(decodeMessage(wire.data(), 31, o, used, reason) == DecodeStatus::Incomplete);
+    REQUIRE(decodeMessage(wire.data(), wire.size(), o, used, reason) == DecodeStatus::Ok);
+    REQUIRE(used == 32);
+    REQUIRE(o.orderId == 1);
+    REQUIRE(o.accountId == 7);
+    REQUIRE(o.symbol == 3);
+    REQUIRE(o.side == Side::SELL);
+    REQUIRE(o.type == OrderType::LIMIT);
+    REQUIRE(o.price == 15025);
+    REQUIRE(o.quantity == 10);
+    REQUIRE(o.timestamp == 0); // stamped by the receiver
+
+    size_t pos = 32;
+    const OrderType types[] = {OrderType::MARKET, OrderType::CANCEL, OrderType::REPLACE};
+    for (OrderType type : types) {
+        REQUIRE(decodeMessage(wire.data() + pos, wire.size() - pos, o, used, reason) == DecodeStatus::Ok);
+        REQUIRE(o.type == type);
+        REQUIRE(o.accountId == 7);
+        pos += used;
+    }
+    REQUIRE(o.price == 15000);
+    REQUIRE(o.quantity == 4);
+
+    wire[0] = 31; // length disagrees with the type
+    REQUIRE(decodeMessage(wire.data(), wire.size(), o, used, reason) == DecodeStatus::BadFrame);
+    wire[0] = 32;
+    wire[6] = 4; // unknown flag
+    REQUIRE(decodeMessage(wire.data(), wire.size(), o, used, reason) == DecodeStatus::Rejected);
+    REQUIRE(reason == BinaryReject::BadType);
+    REQUIRE(used == 32);
+}
+
+TEST_CASE("Binary decoding rejects limit prices out of range", "[OrderEntryServer]") {
+    const Price bad[] = {0, -1, kMaxPrice + 1, INT64_MIN, INT64_MAX};
+    for (Price price : bad) {
+        std::string wire;
+        encodeOrder({1,7,3,Side::BUY,OrderType::LIMIT,price,1,0}, wire);
+        encodeOrder({1,7,3,Side::BUY,OrderType::REPLACE,price,1,0}, wire);
+        Order o;
+        size_t used = 0;
+        BinaryReject reason{};
+        REQUIRE(decodeMessage(wire.data(), wire.size(), o, used, reason) == DecodeStatus::Rejected);
+        REQUIRE(reason == BinaryReject::BadPrice);
+        REQUIRE(decodeMessage(wire.data() + used, wire.size() - used, o, used, reason) == DecodeStatus::Rejected);
+        REQUIRE(reason == BinaryReject::BadPrice);
+    }
+
+    // A MARKET order's price is not looked at; kMaxPrice itself is fine.
+    std::string wire;
+    encodeOrder({1,7,3,Side::BUY,OrderType::MARKET,INT64_MIN,1,0}, wire);
+    encodeOrder({2,7,3,Side::BUY,OrderType::LIMIT,kMaxPrice,1,0}, wire);
+    Order o;
+    size_t used = 0;
+    BinaryReject reason{};
+    REQUIRE(decodeMessage(wire.data(), wire.size(), o, used, reason) == DecodeStatus::Ok);
+    REQUIRE(decodeMessage(wire.data() + used, wire.size() - used, o, used, reason) == DecodeStatus::Ok);
+}
+
+TEST_CASE("Binary listener takes orders and rejects unknown symbols", "[OrderEntryServer]") {
+    auto symbols = std::make_shared<SymbolDirectory>();
+    const SymbolId AAPL = symbols->intern("AAPL");
+    ShardedEngine engines(1, symbols);
+    OrderEntryServer server(engines, 0, 1);
+    unsigned short port = server.addListener(0, WireFormat::Binary);
+    server.start();
+
+    std::string wire;
+    encodeOrder({1,1,AAPL,Side::BUY,OrderType::LIMIT,10000,1,0}, wire);
+    encodeOrder({2,1,AAPL + 1,Side::BUY,OrderType::LIMIT,10000,1,0}, wire);
+    encodeOrder({3,1,AAPL,Side::SELL,OrderType::LIMIT,10100,1,0}, wire);
+
+    boost::asio::io_context ioc;
+    tcp::socket client(ioc);
+    client.connect({boost::asio::ip::address_v4::loopback(), port});
+    boost::asio::write(client, boost::asio::buffer(wire));
+
+    RejectMsg reject;
+    boost::asio::read(client, boost::asio::buffer(&reject, sizeof(reject)));
+    REQUIRE(reject.header.type == MsgType::Reject);
+    REQUIRE(reject.reason == BinaryReject::UnknownSymbol);
+    REQUIRE(reject.orderId == 2);
+    REQUIRE(drainUntil(engines, 2) == 2);
+
+    // A broken frame gets a reject and the connection is closed.
+    boost::asio::write(client, boost::asio::buffer(std::string(8, '\x7f')));
+    boost::asio::read(client, boost::asio::buffer(&reject, sizeof(reject)));
+    REQUIRE(reject.reason == BinaryReject::BadFrame);
+    boost::system::error_code ec;
+    char byte;
+    boost::asio::read(client, boost::asio::buffer(&byte, 1), ec);
+    REQUIRE(ec == boost::asio::error::eof);
+}
+
+TEST_CASE("UDP listener batches datagrams and counts sequence gaps", "[OrderEntryServer]") {
+    auto symbols = std::make_shared<SymbolDirectory>();
+    const SymbolId AAPL = symbols->intern("AAPL");
+    ShardedEngine engines(1, symbols);
+    UdpOrderListener listener(engines, 0, 8);
+
+    // Queued before the thread starts, so the first read takes several.
+    boost::asio::io_context ioc;
+    boost::asio::ip::udp::socket client(ioc, boost::asio::ip::udp::v4());
+    boost::asio::ip::udp::endpoint to(boost::asio::ip::address_v4::loopback(), listener.port());
+    auto send = [&](uint32_t sender, uint64_t seq, std::initializer_list<uint64_t> ids) {
+        std::string d;
+        encodeDatagramHeader(sender, seq, d);
+        for (uint64_t id : ids)
+            encodeOrder({id,1,AAPL,Side::BUY,OrderType::LIMIT,10000,1,0}, d);
+        client.send_to(boost::asio::buffer(d), to);
+    };
+    send(1, 1, {1, 2});
+    send(1, 2, {3});
+    send(1, 5, {4});    // 3 and 4 lost
+    send(1, 4, {99});   // late: dropped
+    send(2, 7, {5});    // first seen from sender 2: no gap
+    send(2, 8, {6, 7, 8});
+    client.send_to(boost::asio::buffer(std::string(5, 'x')), to);
+
+    listener.start();
+    REQUIRE(drainUntil(engines, 8) == 8);
+    REQUIRE(eventually([&] { return listener.stats().malformed == 1; }));
+    listener.stop();
+
+    UdpStats stats = listener.stats();
+    REQUIRE(stats.datagrams == 7);
+    REQUIRE(stats.orders == 8);
+    REQUIRE(stats.reads < stats.datagrams);
+
+    auto senders = listener.senderStats();
+    std::sort(senders.begin(), senders.end(),
+              [](const SenderStats& a, const SenderStats& b) { return a.sender < b.sender; });
+    REQUIRE(senders.size() == 2);
+    REQUIRE(senders[0].datagrams == 3);
+    REQUIRE(senders[0].gaps == 2);
+    REQUIRE(senders[0].stale == 1);
+    REQUIRE(senders[0].lastSequence == 5);
+    REQUIRE(senders[1].datagrams == 2);
+    REQUIRE(senders[1].gaps == 0);
+}
+
+TEST_CASE("UDP listener tracks a bounded number of senders", "[OrderEntryServer]") {
+    auto symbols = std::make_shared<SymbolDirectory>();
+    const SymbolId AAPL = symbols->intern("AAPL");
+    ShardedEngine engines(1, symbols);
+    UdpOrderListener listener(engines, 0, 8, 2);
+
+    boost::asio::io_context ioc;
+    boost::asio::ip::udp::socket client(ioc, boost::asio::ip::udp::v4());
+    boost::asio::ip::udp::endpoint to(boost::asio::ip::address_v4::loopback(), listener.port());
+    auto send = [&](uint32_t sender, uint64_t seq, uint64_t id) {
+        std::string d;
+        encodeDatagramHeader(sender, seq, d);
+        encodeOrder({id,1,AAPL,Side::BUY,OrderType::LIMIT,10000,1,0}, d);
+        client.send_to(boost::asio::buffer(d), to);
+    };
+    send(1, 1, 1);
+    send(2, 1, 2);
+    send(3, 5, 3);  // table full: taken unchecked
+    send(3, 4, 4);  // would be stale
+    send(1, 1, 5);  // restart at 1
+
+    listener.start();
+    REQUIRE(drainUntil(engines, 5) == 5);
+    REQUIRE(eventually([&] { return listener.senderStats().size() == 2; }));
+    listener.stop();
+
+    REQUIRE(listener.stats().untracked == 2);
+    auto senders = listener.senderStats();
+    std::sort(senders.begin(), senders.end(),
+              [](const SenderStats& a, const SenderStats& b) { return a.sender < b.sender; });
+    REQUIRE(senders[0].sender == 1);
+    REQUIRE(senders[0].datagrams == 2);
+    REQUIRE(senders[1].sender == 2);
+}
+
+TEST_CASE("Order entry streams execution reports back to the session", "[OrderEntryServer]") {
+    auto symbols = std::make_shared<SymbolDirectory>();
+    const SymbolId AAPL = symbols->intern("AAPL");
+    ShardedEngine engines(1, symbols);
+    OrderEntryServer server(engines, 0, 1);
+    unsigned short binaryPort = server.addListener(0, WireFormat::Binary, true);
+    unsigned short csvPort = server.addListener(0, WireFormat::Csv, true);
+    server.start();
+
+    EngineThread engineThread(engines);
+
+    boost::asio::io_context ioc;
+    tcp::socket maker(ioc);
+    maker.connect({boost::asio::ip::address_v4::loopback(), binaryPort});
+    std::string wire;
+    encodeOrder({1,1,AAPL,Side::SELL,OrderType::LIMIT,15001,5,0}, wire);
+    boost::asio::write(maker, boost::asio::buffer(wire));
+    ExecReportMsg ack;
+    boost::asio::read(maker, boost::asio::buffer(&ack, sizeof(ack)));
+    REQUIRE(ack.header.type == MsgType::ExecReport);
+    REQUIRE(ack.execType == 0);
+    REQUIRE(ack.orderId == 1);
+
+    tcp::socket taker(ioc);
+    taker.connect({boost::asio::ip::address_v4::loopback(), csvPort});
+    auto exchange = [&](const std::string& lines, const std::string& expected) {
+        boost::asio::write(taker, boost::asio::buffer(lines));
+        std::string got(expected.size(), '\0');
+        boost::asio::read(taker, boost::asio::buffer(&got[0], got.size()));
+        return got == expected;
+    };
+    REQUIRE(exchange("2,2,AAPL,0,0,150.01,3,0\n", "ACK,2\nFILL,2,1,150.01,3\n"));
+    REQUIRE(exchange("3,2,AAPL,0,0,149.5,1,0\n", "ACK,3\n"));
+    REQUIRE(exchange("3,2,AAPL,0,2,0,0,0\n9,2,AAPL,0,2,0,0,0\n",
+                     "CANCELLED,3\nREJECT,9,UNKNOWN_ORDER\n"));
+
+    ExecReportMsg fill;
+    boost::asio::read(maker, boost::asio::buffer(&fill, sizeof(fill)));
+    REQUIRE(fill.execType == 1);
+    REQUIRE(fill.orderId == 1);
+    REQUIRE(fill.price == 15001);
+    REQUIRE(fill.quantity == 3);
+}
+
+TEST_CASE("Write-only clients are not sent execution reports", "[OrderEntryServer]") {
+    auto symbols = std::make_shared<SymbolDirectory>();
+    symbols->intern("AAPL");
+    IngressConfig ingress;
+    ingress.reportCapacity = 8;
+    ShardedEngine engines(1, symbols, PoolConfig{}, WaitMode::Block, ingress);
+    OrderEntryServer server(engines, 0, 1);
+    server.start();
+
+    // Like feed_orders.py: writes, never reads.
+    boost::asio::io_context ioc;
+    tcp::socket feeder(ioc);
+    feeder.connect({boost::asio::ip::address_v4::loopback(), server.port()});
+    std::string lines;
+    for (int i = 1; i <= 100; ++i)
+        lines += std::to_string(i) + ",1,AAPL,0,0,100.00,1,0\n";
+    boost::asio::write(feeder, boost::asio::buffer(lines));
+
+    // Far more reports than the session could hold, had it asked for them.
+    Order batch[64];
+    std::vector<Trade> trades;
+    size_t seen = 0;
+    REQUIRE(eventually([&] {
+        size_t n = engines.drain(0, batch, 64);
+        for (size_t i = 0; i < n; ++i) {
+            bool applied = engines.engine(0).onNewOrder(batch[i], trades);
+            engines.report(0, batch[i], applied, trades.data(), 0);
+        }
+        engines.flushReports(0);
+        seen += n;
+        return seen == 100;
+    }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    REQUIRE(server.connections() == 1);
+
+    boost::asio::write(feeder, boost::asio::buffer(std::string("101,1,AAPL,0,0,100.00,1,0\n")));
+    REQUIRE(drainUntil(engines, 1) == 1);
+    REQUIRE(feeder.available() == 0);
+}
+
+TEST_CASE("Clients that stop reading their reports are disconnected", "[OrderEntryServer]") {
+    auto symbols = std::make_shared<SymbolDirectory>();
+    symbols->intern("AAPL");
+    IngressConfig ingress;
+    ingress.reportCapacity = 1 << 16; // so only the byte cap can trip
+    ShardedEngine engines(1, symbols, PoolConfig{}, WaitMode::Block, ingress);
+    OrderEntryServer server(engines, 0, 1, 16 * 1024);
+    unsigned short port = server.addListener(0, WireFormat::Csv, true);
+    server.start();
+    EngineThread engineThread(engines);
+
+    boost::asio::io_context ioc;
+    tcp::socket client(ioc);
+    client.open(tcp::v4());
+    client.set_option(boost::asio::socket_base::receive_buffer_size(4096));
+    client.connect({boost::asio::ip::address_v4::loopback(), port});
+    REQUIRE(eventually([&] { return server.connections() == 1; }));
+
+    // Each order is acked; the client never reads a byte.
+    std::string lines;
+    for (int i = 1; i <= 100000; ++i)
+        lines += std::to_string(i) + ",1,AAPL,0,0,100.00,1,0\n";
+    boost::system::error_code ec;
+    boost::asio::write(client, boost::asio::buffer(lines), ec);
+    REQUIRE(eventually([&] { return server.connections() == 0; }));
+}
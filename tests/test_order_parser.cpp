@@ -0,0 +1,84 @@
+#include "catch.hpp"
+#include "../src/OrderParser.h"
+#include <string>
+#include <vector>
+
+TEST_CASE("Order lines parse into orders", "[OrderParser]") {
+    SymbolDirectory symbols;
+    OrderParser parser(symbols);
+    Order o{};
+    REQUIRE(parser.parse("7,3,AAPL,1,0,150.25,10,99", o) == ParseError::None);
+    REQUIRE(o.orderId == 7);
+    REQUIRE(o.accountId == 3);
+    REQUIRE(o.symbol == symbols.find("AAPL"));
+    REQUIRE(o.side == Side::SELL);
+    REQUIRE(o.type == OrderType::LIMIT);
+    REQUIRE(o.price == 15025);
+    REQUIRE(o.quantity == 10);
+    REQUIRE(o.timestamp == 99);
+
+    REQUIRE(parser.parse("8,3,AAPL,0,3,150,0,99\r", o) == ParseError::None);
+    REQUIRE(o.type == OrderType::REPLACE);
+    REQUIRE(o.price == 15000);
+}
+
+TEST_CASE("Prices convert to ticks from their decimal digits", "[OrderParser]") {
+    SymbolDirectory symbols(0.01);
+    symbols.setTickSize("ES", 0.25);
+    symbols.setTickSize("ODD", 0.3);
+    OrderParser parser(symbols);
+    Order o{};
+    auto price = [&](const std::string& sym, const std::string& p) {
+        REQUIRE(parser.parse("1,1," + sym + ",0,0," + p + ",1,0", o) == ParseError::None);
+        return o.price;
+    };
+
+    REQUIRE(price("AAPL", "150.01") == 15001);
+    REQUIRE(price("AAPL", "0.29") == 29);
+    REQUIRE(price("AAPL", "-1.5") == -150);
+    REQUIRE(price("AAPL", ".07") == 7);
+    REQUIRE(price("AAPL", "12.") == 1200);
+    REQUIRE(price("AAPL", "1.005") == 101);    // 1.005 / 0.01 is 100.4999... in doubles
+    REQUIRE(price("AAPL", "1.0049999999999") == 100);
+    REQUIRE(price("ES", "4321.75") == 17287);
+    REQUIRE(price("ODD", "0.9") == 3);         // tick does not divide the unit
+}
+
+TEST_CASE("Malformed lines report an error code", "[OrderParser]") {
+    SymbolDirectory symbols;
+    OrderParser parser(symbols);
+    Order o{};
+    REQUIRE(parser.parse("x,1,AAPL,0,0,1,1,0", o) == ParseError::BadNumber);
+    REQUIRE(parser.parse("5,1,AAPL,0,0,1,1", o) == ParseError::MissingField);
+    REQUIRE(o.orderId == 5);
+    REQUIRE(parser.parse("5,1,,0,0,1,1,0", o) == ParseError::UnknownSymbol);
+    REQUIRE(parser.parse("5,1,AAPL,2,0,1,1,0", o) == ParseError::BadSide);
+    REQUIRE(parser.parse("5,1,AAPL,0,4,1,1,0", o) == ParseError::BadType);
+    REQUIRE(parser.parse("5,1,AAPL,0,0,1e3,1,0", o) == ParseError::BadPrice);
+    REQUIRE(parser.parse("5,1,AAPL,0,0,1.2.3,1,0", o) == ParseError::BadPrice);
+    REQUIRE(parser.parse("5,1,AAPL,0,0,-,1,0", o) == ParseError::BadPrice);
+    REQUIRE(parser.parse("5,1,AAPL,0,0,1,-1,0", o) == ParseError::BadNumber);
+    REQUIRE(parser.parse("5,1,AAPL,0,0,1,1,0 ", o) == ParseError::BadNumber);
+    REQUIRE(parser.parse("5,1,AAPL,0,0,1,1,0,9", o) == ParseError::TrailingData);
+    REQUIRE(std::string(parseErrorName(ParseError::BadPrice)) == "BAD_PRICE");
+}
+
+TEST_CASE("Several lines parse from one buffer", "[OrderParser]") {
+    SymbolDirectory symbols;
+    OrderParser parser(symbols);
+    std::string buf = "1,1,AAPL,0,0,1,1,0\n\n2,1,AAPL,9,0,1,1,0\n3,1,AAPL,1,0,2,1,0\n4,1,AAPL,0,0,3";
+    std::vector<uint64_t> ids;
+    std::vector<ParseError> errors;
+    auto onError = [&](ParseError e, const Order&) { errors.push_back(e); };
+
+    size_t used = parser.parseLines(buf, [&](const Order& o) { ids.push_back(o.orderId); return true; }, onError);
+    REQUIRE(ids == std::vector<uint64_t>{1, 3});
+    REQUIRE(errors == std::vector<ParseError>{ParseError::BadSide});
+    REQUIRE(buf.substr(used) == "4,1,AAPL,0,0,3"); // partial line left for the next read
+
+    // Stopping after a line consumes exactly that line.
+    ids.clear();
+    used = parser.parseLines(buf, [&](const Order& o) { ids.push_back(o.orderId); return false; }, onError);
+    REQUIRE(ids == std::vector<uint64_t>{1});
+    REQUIRE(used == buf.find('\n') + 1);
+}
@@ -0,0 +1,407 @@
+#include "catch.hpp"
+#include "../src/ShardedEngine.h"
+#include <atomic>
+#include <chrono>
+#include <set>
+#include <thread>
+
+TEST_CASE("Shards route symbols by pin or by name hash", "[ShardedEngine]") {
+    auto symbols = std::make_shared<SymbolDirectory>();
+    symbols->loadShards("AAPL:2,MSFT:5");
+    ShardedEngine engines(4, symbols);
+
+    const SymbolId AAPL = symbols->find("AAPL");
+    const SymbolId MSFT = symbols->find("MSFT");
+    const SymbolId TSLA = symbols->intern("TSLA");
+    REQUIRE(engines.size() == 4);
+    REQUIRE(engines.shardOf(AAPL) == 2);
+    REQUIRE(engines.shardOf(MSFT) == 1); // pins wrap to the shard count
+    REQUIRE(engines.shardOf(TSLA) == std::hash<std::string>{}("TSLA") % 4);
+    REQUIRE(engines.shardOf(TSLA) == engines.shardOf(TSLA));
+
+    engines.submit({1,1,AAPL,Side::BUY,OrderType::LIMIT,10000,1,0});
+    Order o;
+    REQUIRE(engines.queue(2).try_dequeue(o));
+    REQUIRE(o.orderId == 1);
+}
+
+TEST_CASE("Shards match in parallel with disjoint trade ids", "[ShardedEngine]") {
+    auto symbols = std::make_shared<SymbolDirectory>();
+    const char* names[] = {"S0", "S1", "S2", "S3", "S4", "S5", "S6", "S7"};
+    for (int i = 0; i < 8; ++i)
+        symbols->setShard(names[i], i % 4);
+    ShardedEngine engines(4, symbols);
+
+    const uint64_t perSymbol = 500;
+    std::vector<std::vector<Trade>> fills(engines.size());
+    std::vector<std::thread> workers;
+    for (size_t k = 0; k < engines.size(); ++k) {
+        workers.emplace_back([&, k] {
+            Order o;
+            while (fills[k].size() < 2 * perSymbol) // two symbols per shard
+                if (engines.queue(k).try_dequeue(o))
+                    engines.engine(k).onNewOrder(o, fills[k]);
+        });
+    }
+
+    uint64_t id = 1;
+    for (uint64_t i = 0; i < perSymbol; ++i) {
+        for (SymbolId s = 0; s < 8; ++s) {
+            engines.submit({id++,1,s,Side::SELL,OrderType::LIMIT,10000,1,i});
+            engines.submit({id++,2,s,Side::BUY,OrderType::LIMIT,10000,1,i});
+        }
+    }
+    for (auto& w : workers)
+        w.join();
+
+    std::set<uint64_t> tradeIds;
+    size_t misrouted = 0, reordered = 0;
+    for (size_t k = 0; k < engines.size(); ++k) {
+        for (const auto& t : fills[k]) {
+            misrouted += engines.shardOf(t.symbol) != k;
+            reordered += t.buyOrderId != t.sellOrderId + 1; // per-symbol order kept
+            tradeIds.insert(t.tradeId);
+        }
+    }
+    REQUIRE(misrouted == 0);
+    REQUIRE(reordered == 0);
+    REQUIRE(tradeIds.size() == 8 * perSymbol);
+}
+
+TEST_CASE("Every wait strategy wakes on new input and reports idle time", "[ShardedEngine]") {
+    for (WaitMode mode : {WaitMode::Spin, WaitMode::SpinYield, WaitMode::Block}) {
+        auto symbols = std::make_shared<SymbolDirectory>();
+        const SymbolId AAPL = symbols->intern("AAPL");
+        ShardedEngine engines(1, symbols, PoolConfig{}, mode);
+        REQUIRE(engines.waiter(0).mode() == mode);
+
+        std::thread consumer([&] {
+            auto& q = engines.queue(0);
+            engines.waiter(0).waitUntil([&] { return q.size_approx() != 0; });
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        engines.submit({1,1,AAPL,Side::BUY,OrderType::LIMIT,10000,1,0});
+        consumer.join();
+
+        REQUIRE(engines.waiter(0).idlePeriods() == 1);
+        REQUIRE(engines.waiter(0).idleNanos() > 0);
+    }
+    REQUIRE(parseWaitMode("spin") == WaitMode::Spin);
+    REQUIRE(parseWaitMode("yield") == WaitMode::SpinYield);
+    REQUIRE(parseWaitMode("block") == WaitMode::Block);
+}
+
+TEST_CASE("Session lanes are drained fairly", "[ShardedEngine]") {
+    auto symbols = std::make_shared<SymbolDirectory>();
+    const SymbolId AAPL = symbols->intern("AAPL");
+    IngressConfig ingress;
+    ingress.quantum = 4;
+    ShardedEngine engines(1, symbols, PoolConfig{}, WaitMode::Block, ingress);
+
+    auto flood = engines.openSession();
+    auto quiet = engines.openSession();
+    REQUIRE(flood->id() != quiet->id());
+    for (uint64_t i = 1; i <= 1000; ++i)
+        flood->submit({i,1,AAPL,Side::BUY,OrderType::LIMIT,10000,1,0});
+    for (uint64_t i = 5001; i <= 5003; ++i)
+        quiet->submit({i,2,AAPL,Side::BUY,OrderType::LIMIT,10000,1,0});
+    REQUIRE(engines.hasInput(0));
+
+    // The quiet session's orders make the first batch despite the backlog.
+    Order batch[16];
+    size_t n = engines.drain(0, batch, 16);
+    REQUIRE(n == 16);
+    size_t quietSeen = 0;
+    for (size_t i = 0; i < n; ++i)
+        quietSeen += batch[i].orderId > 5000;
+    REQUIRE(quietSeen == 3);
+
+    auto stats = engines.sessionStats(0);
+    REQUIRE(stats.size() == 2);
+    for (const auto& st : stats) {
+        if (st.session == flood->id()) {
+            REQUIRE(st.accepted == 1000);
+            REQUIRE(st.depth == 1000 - 13);
+        } else {
+            REQUIRE(st.accepted == 3);
+            REQUIRE(st.depth == 0);
+        }
+    }
+
+    // A closed session's slot is reused once its lane has drained.
+    quiet.reset();
+    REQUIRE(engines.sessionStats(0).size() == 1);
+    auto next = engines.openSession();
+    REQUIRE(engines.sessionStats(0).size() == 2);
+    REQUIRE(engines.sessionStats(0)[1].accepted == 0);
+}
+
+TEST_CASE("High-water mark rejects new orders but not cancels or replaces", "[ShardedEngine]") {
+    auto symbols = std::make_shared<SymbolDirectory>();
+    const SymbolId AAPL = symbols->intern("AAPL");
+    IngressConfig ingress;
+    ingress.highWater = 4;
+    ingress.overload = OverloadPolicy::Reject;
+    ShardedEngine engines(1, symbols, PoolConfig{}, WaitMode::Block, ingress);
+
+    auto session = engines.openSession();
+    for (uint64_t i = 1; i <= 4; ++i)
+        REQUIRE(session->submit({i,1,AAPL,Side::BUY,OrderType::LIMIT,10000,1,0}) == RejectReason::None);
+    REQUIRE(engines.depth(0) == 4);
+
+    REQUIRE(session->submit({5,1,AAPL,Side::BUY,OrderType::LIMIT,10000,1,0}) == RejectReason::Overloaded);
+    REQUIRE_FALSE(engines.submit({6,1,AAPL,Side::BUY,OrderType::LIMIT,10000,1,0}));
+    REQUIRE(session->submit({99,1,AAPL,Side::BUY,OrderType::CANCEL,0,0,0}) == RejectReason::None);
+    REQUIRE(session->submit({98,1,AAPL,Side::BUY,OrderType::REPLACE,9900,1,0}) == RejectReason::None);
+    REQUIRE(engines.rejected(0) == 2);
+    REQUIRE(engines.depth(0) == 6);
+
+    Order batch[8];
+    REQUIRE(engines.drain(0, batch, 8) == 6);
+    REQUIRE(engines.depth(0) == 0);
+    REQUIRE(session->submit({7,1,AAPL,Side::BUY,OrderType::LIMIT,10000,1,0}) == RejectReason::None);
+    REQUIRE(std::string(rejectReasonName(RejectReason::Overloaded)) == "OVERLOADED");
+}
+
+TEST_CASE("High-water mark holds back submitters until the shard drains", "[ShardedEngine]") {
+    auto symbols = std::make_shared<SymbolDirectory>();
+    const SymbolId AAPL = symbols->intern("AAPL");
+    IngressConfig ingress;
+    ingress.highWater = 2;
+    ShardedEngine engines(1, symbols, PoolConfig{}, WaitMode::Block, ingress);
+
+    auto session = engines.openSession();
+    session->submit({1,1,AAPL,Side::BUY,OrderType::LIMIT,10000,1,0});
+    session->submit({2,1,AAPL,Side::BUY,OrderType::LIMIT,10000,1,0});
+
+    std::atomic<bool> done{false};
+    std::thread producer([&] {
+        session->submit({3,1,AAPL,Side::BUY,OrderType::LIMIT,10000,1,0});
+        done = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    REQUIRE_FALSE(done);
+
+    Order batch[4];
+    REQUIRE(engines.drain(0, batch, 4) == 2);
+    producer.join();
+    REQUIRE(engines.depth(0) == 1);
+    REQUIRE(engines.rejected(0) == 0);
+}
+
+TEST_CASE("Cancels overtake their session's queued orders", "[ShardedEngine]") {
+    auto symbols = std::make_shared<SymbolDirectory>();
+    const SymbolId AAPL = symbols->intern("AAPL");
+    ShardedEngine engines(1, symbols);
+
+    auto session = engines.openSession();
+    session->submit({1,1,AAPL,Side::BUY,OrderType::LIMIT,10000,5,0});
+    session->submit({2,1,AAPL,Side::BUY,OrderType::LIMIT,10000,5,0});
+    session->submit({3,1,AAPL,Side::BUY,OrderType::LIMIT,10000,5,0});
+    session->submit({2,1,AAPL,Side::BUY,OrderType::CANCEL,0,0,0});
+    session->submit({3,1,AAPL,Side::BUY,OrderType::REPLACE,9900,2,0});
+    session->submit({4,1,AAPL,Side::BUY,OrderType::LIMIT,10000,5,0});
+    REQUIRE(engines.depth(0) == 6);
+
+    // Cancel and replace come first; order 2 never reaches the engine and
+    // order 3 arrives already replaced.
+    Order batch[16];
+    size_t n = engines.drain(0, batch, 16);
+    REQUIRE(n == 5);
+    REQUIRE(batch[0].type == OrderType::CANCEL);
+    REQUIRE(batch[1].type == OrderType::REPLACE);
+    REQUIRE(batch[2].orderId == 1);
+    REQUIRE(batch[3].orderId == 3);
+    REQUIRE(batch[3].price == 9900);
+    REQUIRE(batch[3].quantity == 2);
+    REQUIRE(batch[4].orderId == 4);
+    REQUIRE(engines.depth(0) == 0);
+
+    PriorityStats stats = engines.priorityStats(0);
+    REQUIRE(stats.cancels == 2);
+    REQUIRE(stats.overtaken == 6);
+    REQUIRE(stats.avoided == 2);
+
+    // A cancel with nothing of its own queued ahead is passed straight on.
+    session->submit({1,1,AAPL,Side::BUY,OrderType::CANCEL,0,0,0});
+    session->submit({5,1,AAPL,Side::BUY,OrderType::LIMIT,10000,5,0});
+    REQUIRE(engines.drain(0, batch, 16) == 2);
+    REQUIRE(batch[0].type == OrderType::CANCEL);
+    REQUIRE(batch[1].orderId == 5);
+    REQUIRE(engines.priorityStats(0).cancels == 2);
+}
+
+struct ShardedEngineTestAccess {
+    // What drain() does when a cancel lands just after it popped `session`'s
+    // next order: the order is taken but held back for the cancel.
+    static void holdNext(ShardedEngine& engines, const ShardedEngine::Session& session) {
+        size_t slot = (session.id() - 1) % engines.ingress_.maxSessions;
+        auto& lane = *engines.slots_[slot].lanes[0];
+        REQUIRE(lane.ring.try_pop(lane.held));
+        ++lane.taken;
+        lane.holding.store(true);
+    }
+};
+
+TEST_CASE("A cancel queued while its target is held still catches it", "[ShardedEngine]") {
+    auto symbols = std::make_shared<SymbolDirectory>();
+    const SymbolId AAPL = symbols->intern("AAPL");
+    ShardedEngine engines(1, symbols);
+    auto session = engines.openSession();
+    std::vector<ExecReport> reports;
+    session->onReports([] {});
+
+    session->submit({7,1,AAPL,Side::BUY,OrderType::LIMIT,10000,5,0});
+    session->submit({8,1,AAPL,Side::BUY,OrderType::LIMIT,9900,5,0});
+    ShardedEngineTestAccess::holdNext(engines, *session);
+    session->submit({7,1,AAPL,Side::BUY,OrderType::CANCEL,0,0,0});
+
+    Order batch[16];
+    std::vector<Trade> trades;
+    size_t n = engines.drain(0, batch, 16);
+    REQUIRE(n == 2);
+    REQUIRE(batch[0].type == OrderType::CANCEL);
+    REQUIRE(batch[1].orderId == 8);
+    REQUIRE(engines.depth(0) == 0);
+    REQUIRE(engines.priorityStats(0).avoided == 1);
+
+    for (size_t i = 0; i < n; ++i) {
+        bool applied = engines.engine(0).onNewOrder(batch[i], trades);
+        engines.report(0, batch[i], applied, trades.data(), 0);
+    }
+    engines.flushReports(0);
+    REQUIRE(engines.engine(0).snapshotBook(AAPL, 5).size() == 1);
+    REQUIRE(engines.engine(0).snapshotBook(AAPL, 5)[0].price == 9900);
+
+    session->pollReports([&](const ExecReport& r) { reports.push_back(r); });
+    REQUIRE(reports.size() == 2);
+    REQUIRE(reports[0].type == ExecType::Cancelled);
+    REQUIRE(reports[0].orderId == 7);
+    REQUIRE(reports[1].type == ExecType::Ack);
+    REQUIRE(reports[1].orderId == 8);
+}
+
+TEST_CASE("Parked cancels are matched by session as well as order id", "[ShardedEngine]") {
+    auto symbols = std::make_shared<SymbolDirectory>();
+    const SymbolId AAPL = symbols->intern("AAPL");
+    ShardedEngine engines(1, symbols);
+    auto a = engines.openSession();
+    auto b = engines.openSession();
+    a->onReports([] {});
+    b->onReports([] {});
+
+    // Both sessions use id 7; a also cancels then replaces its id 9.
+    a->submit({7,1,AAPL,Side::BUY,OrderType::LIMIT,10000,5,0});
+    a->submit({9,1,AAPL,Side::BUY,OrderType::LIMIT,9700,5,0});
+    b->submit({7,2,AAPL,Side::BUY,OrderType::LIMIT,9900,5,0});
+    a->submit({7,1,AAPL,Side::BUY,OrderType::CANCEL,0,0,0});
+    a->submit({9,1,AAPL,Side::BUY,OrderType::CANCEL,0,0,0});
+    a->submit({9,1,AAPL,Side::BUY,OrderType::REPLACE,9600,3,0});
+    b->submit({7,2,AAPL,Side::BUY,OrderType::REPLACE,9800,3,0});
+
+    Order batch[16];
+    std::vector<Trade> trades;
+    size_t n = engines.drain(0, batch, 16);
+    REQUIRE(engines.priorityStats(0).avoided == 3);
+    for (size_t i = 0; i < n; ++i) {
+        bool applied = engines.engine(0).onNewOrder(batch[i], trades);
+        engines.report(0, batch[i], applied, trades.data(), 0);
+    }
+    engines.flushReports(0);
+
+    auto book = engines.engine(0).snapshotBook(AAPL, 5);
+    REQUIRE(book.size() == 1);
+    REQUIRE(book[0].price == 9800);
+    REQUIRE(book[0].quantity == 3);
+
+    std::vector<ExecReport> ra, rb;
+    a->pollReports([&](const ExecReport& r) { ra.push_back(r); });
+    b->pollReports([&](const ExecReport& r) { rb.push_back(r); });
+    REQUIRE(ra.size() == 3);
+    REQUIRE(ra[0].type == ExecType::Cancelled);
+    REQUIRE(ra[0].orderId == 7);
+    REQUIRE(ra[1].type == ExecType::Cancelled);
+    REQUIRE(ra[1].orderId == 9);
+    REQUIRE(ra[2].type == ExecType::Rejected);
+    REQUIRE(ra[2].orderId == 9);
+    REQUIRE(rb.size() == 2);
+    REQUIRE(rb[0].type == ExecType::Replaced);
+    REQUIRE(rb[0].quantity == 3);
+    REQUIRE(rb[1].type == ExecType::Ack);
+    REQUIRE(rb[1].price == 9800);
+}
+
+TEST_CASE("Execution reports reach both sides of a fill", "[ShardedEngine]") {
+    auto symbols = std::make_shared<SymbolDirectory>();
+    const SymbolId AAPL = symbols->intern("AAPL");
+    ShardedEngine engines(1, symbols);
+    MatchingEngine& engine = engines.engine(0);
+
+    auto maker = engines.openSession();
+    auto taker = engines.openSession();
+    auto silent = engines.openSession(); // never asks for reports
+    int makerWakes = 0;
+    int takerWakes = 0;
+    maker->onReports([&] { ++makerWakes; });
+    taker->onReports([&] { ++takerWakes; });
+
+    auto run = [&] {
+        Order batch[16];
+        std::vector<Trade> trades;
+        size_t n = engines.drain(0, batch, 16);
+        for (size_t i = 0; i < n; ++i) {
+            size_t first = trades.size();
+            bool applied = engine.onNewOrder(batch[i], trades);
+            engines.report(0, batch[i], applied, trades.data() + first, trades.size() - first);
+        }
+        engines.flushReports(0);
+    };
+    auto poll = [](ShardedEngine::Session& s) {
+        std::vector<ExecReport> out;
+        s.pollReports([&](const ExecReport& r) { out.push_back(r); });
+        return out;
+    };
+
+    maker->submit({1,1,AAPL,Side::SELL,OrderType::LIMIT,10000,5,0});
+    maker->submit({2,1,AAPL,Side::SELL,OrderType::LIMIT,10100,5,0});
+    silent->submit({3,3,AAPL,Side::SELL,OrderType::LIMIT,10200,5,0});
+    run();
+    REQUIRE(makerWakes == 1);
+    REQUIRE(poll(*maker).size() == 2);
+
+    taker->submit({10,2,AAPL,Side::BUY,OrderType::MARKET,0,20,0});
+    run();
+    REQUIRE(makerWakes == 2);
+    REQUIRE(takerWakes == 1);
+
+    auto made = poll(*maker);
+    REQUIRE(made.size() == 2);
+    REQUIRE(made[0].type == ExecType::Fill);
+    REQUIRE(made[0].orderId == 1);
+    REQUIRE(made[1].orderId == 2);
+    REQUIRE(made[1].price == 10100);
+
+    auto took = poll(*taker);
+    REQUIRE(took.size() == 5); // ack, three fills, unfilled rest
+    REQUIRE(took[0].type == ExecType::Ack);
+    REQUIRE(took[2].type == ExecType::Fill);
+    REQUIRE(took[2].tradeId == made[1].tradeId);
+    REQUIRE(took[3].price == 10200);
+    REQUIRE(took[4].type == ExecType::Cancelled);
+    REQUIRE(took[4].quantity == 5);
+    REQUIRE(poll(*silent).empty());
+
+    // Nothing pending re-arms the wake; a cancel that overtakes its target
+    // in the lane is confirmed once, not rejected by the engine first.
+    taker->submit({11,2,AAPL,Side::BUY,OrderType::LIMIT,9000,5,0});
+    taker->submit({11,2,AAPL,Side::BUY,OrderType::CANCEL,0,0,0});
+    taker->submit({12,2,AAPL,Side::BUY,OrderType::CANCEL,0,0,0});
+    run();
+    REQUIRE(takerWakes == 2);
+    took = poll(*taker);
+    REQUIRE(took.size() == 2);
+    REQUIRE(took[0].type == ExecType::Cancelled);
+    REQUIRE(took[0].orderId == 11);
+    REQUIRE(took[1].type == ExecType::Rejected);
+    REQUIRE(took[1].orderId == 12);
+}
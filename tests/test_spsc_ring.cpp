@@ -0,0 +1,145 @@
+#include "catch.hpp"
+#include "../src/EventChannel.h"
+#include "../src/SequencedRing.h"
+#include "../src/ShardedEngine.h"
+#include <thread>
+
+TEST_CASE("SPSC ring is FIFO, bounded and wraps around", "[SpscRing]") {
+    SpscRing<int> ring(3);
+    REQUIRE(ring.capacity() == 4);
+
+    int v = 0;
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 4; ++i)
+            REQUIRE(ring.try_push(round * 10 + i));
+        REQUIRE_FALSE(ring.try_push(99));
+        REQUIRE(ring.size_approx() == 4);
+        for (int i = 0; i < 4; ++i) {
+            REQUIRE(ring.try_pop(v));
+            REQUIRE(v == round * 10 + i);
+        }
+        REQUIRE_FALSE(ring.try_pop(v));
+    }
+}
+
+TEST_CASE("SPSC ring hands every item across threads in order", "[SpscRing]") {
+    SpscRing<uint64_t> ring(64);
+    const uint64_t N = 200000;
+    std::thread producer([&] {
+        for (uint64_t i = 0; i < N; ++i)
+            while (!ring.try_push(i))
+                std::this_thread::yield();
+    });
+
+    uint64_t expected = 0, v = 0, outOfOrder = 0;
+    while (expected < N) {
+        if (ring.try_pop(v))
+            outOfOrder += v != expected++;
+        else
+            std::this_thread::yield();
+    }
+    producer.join();
+    REQUIRE(outOfOrder == 0);
+}
+
+TEST_CASE("Event channel overflow policies", "[SpscRing]") {
+    Order o{1,1,0,Side::BUY,OrderType::LIMIT,10000,1,0};
+
+    EventChannel dropping(2, OverflowPolicy::Drop);
+    REQUIRE(dropping.push(o));
+    REQUIRE(dropping.push(o));
+    REQUIRE_FALSE(dropping.push(o));
+    REQUIRE(dropping.dropped() == 1);
+
+    // Blocking waits for the publisher to make room and loses nothing.
+    EventChannel blocking(2, OverflowPolicy::Block);
+    std::thread producer([&] {
+        for (uint64_t i = 1; i <= 100; ++i) {
+            o.orderId = i;
+            blocking.push(o);
+        }
+        blocking.publish();
+    });
+    EngineEvent e;
+    uint64_t next = 1;
+    while (next <= 100) {
+        if (blocking.pop(e))
+            REQUIRE(std::get<Order>(e).orderId == next++);
+        else
+            blocking.waitForEvents();
+    }
+    producer.join();
+    REQUIRE(blocking.dropped() == 0);
+}
+
+TEST_CASE("Sequenced ring delivers every producer's items in claim order", "[SequencedRing]") {
+    SequencedRing<uint64_t> ring(8);
+    int64_t seq = 0;
+    for (uint64_t i = 0; i < 8; ++i) {
+        REQUIRE(ring.tryClaim(seq));
+        ring[seq] = i;
+    }
+    REQUIRE_FALSE(ring.tryClaim(seq));
+    REQUIRE_FALSE(ring.available());
+    ring.publish(1); // out of order: nothing visible until 0 is published
+    REQUIRE_FALSE(ring.available());
+    for (int64_t s = 0; s < 8; ++s)
+        ring.publish(s);
+    std::vector<uint64_t> seen;
+    REQUIRE(ring.poll([&](uint64_t v) { seen.push_back(v); }, 5) == 5);
+    REQUIRE(ring.tryClaim(seq));
+    REQUIRE(seq == 8);
+    ring.publish(seq);
+
+    REQUIRE(ring.poll([](uint64_t) {}, 8) == 4); // the 3 left above plus slot 8
+
+    SequencedRing<uint64_t> shared(1024);
+    const uint64_t perProducer = 50000;
+    std::vector<std::thread> producers;
+    for (uint64_t p = 0; p < 3; ++p) {
+        producers.emplace_back([&, p] {
+            for (uint64_t i = 0; i < perProducer; ++i) {
+                int64_t s = shared.claim();
+                shared[s] = (p << 32) | i;
+                shared.publish(s);
+            }
+        });
+    }
+    uint64_t next[3] = {0, 0, 0}, bad = 0, total = 0;
+    while (total < 3 * perProducer) {
+        size_t n = shared.poll([&](uint64_t v) {
+            uint64_t p = v >> 32;
+            bad += (v & 0xffffffff) != next[p]++;
+        }, 64);
+        if (n == 0)
+            std::this_thread::yield();
+        total += n;
+    }
+    for (auto& t : producers)
+        t.join();
+    REQUIRE(bad == 0);
+}
+
+TEST_CASE("Ring ingress mode feeds the shard in arrival order", "[SequencedRing]") {
+    auto symbols = std::make_shared<SymbolDirectory>();
+    const SymbolId AAPL = symbols->intern("AAPL");
+    IngressConfig ingress;
+    ingress.mode = IngressMode::Ring;
+    ingress.ringCapacity = 64;
+    ShardedEngine engines(1, symbols, PoolConfig{}, WaitMode::Block, ingress);
+
+    auto a = engines.openSession();
+    auto b = engines.openSession();
+    a->submit({1,1,AAPL,Side::BUY,OrderType::LIMIT,10000,1,0});
+    b->submit({2,2,AAPL,Side::SELL,OrderType::LIMIT,10000,1,0});
+    a->submit({3,1,AAPL,Side::BUY,OrderType::LIMIT,10000,1,0});
+    REQUIRE(engines.hasInput(0));
+
+    Order batch[8];
+    REQUIRE(engines.drain(0, batch, 8) == 3);
+    REQUIRE(batch[0].orderId == 1);
+    REQUIRE(batch[1].orderId == 2);
+    REQUIRE(batch[2].orderId == 3);
+    REQUIRE_FALSE(engines.hasInput(0));
+    REQUIRE(engines.sessionStats(0)[0].accepted == 2);
+}
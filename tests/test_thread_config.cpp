@@ -0,0 +1,33 @@
+#include "catch.hpp"
+#include "../src/ThreadConfig.h"
+
+TEST_CASE("CPU lists parse singles and ranges", "[ThreadConfig]") {
+    REQUIRE(parseCpuList("2", 8) == std::vector<int>{2});
+    REQUIRE(parseCpuList("0,2,4-6", 8) == std::vector<int>{0, 2, 4, 5, 6});
+    REQUIRE(parseCpuList("x,3", 8) == std::vector<int>{3});
+    REQUIRE(parseCpuList("", 8).empty());
+    REQUIRE(configuredCpuCount() >= 1);
+}
+
+TEST_CASE("CPU lists skip bad entries and stay within the configured CPUs", "[ThreadConfig]") {
+    REQUIRE(parseCpuList("3x,1", 8) == std::vector<int>{1});
+    REQUIRE(parseCpuList("-1,5-2,2-,0", 8) == std::vector<int>{0});
+    REQUIRE(parseCpuList("9,1", 8) == std::vector<int>{1});
+    REQUIRE(parseCpuList("6-2000000000", 8) == std::vector<int>{6, 7});
+    REQUIRE(parseCpuList("99999999999", 8).empty());
+}
+
+TEST_CASE("Per-shard roles get one CPU each", "[ThreadConfig]") {
+    ThreadConfig cfg;
+    cfg.role(ThreadRole::Engine).cpus = {2, 3};
+    cfg.role(ThreadRole::Engine).rtPriority = 50;
+    cfg.role(ThreadRole::Http).cpus = {0, 1};
+
+    auto text = cfg.describe(3);
+    REQUIRE(text.find("engine: shard 0 on cpu 2, shard 1 on cpu 3, shard 2 on cpu 2, SCHED_FIFO 50") != std::string::npos);
+    REQUIRE(text.find("http: cpus 0,1") != std::string::npos);
+    REQUIRE(text.find("publisher: unpinned") != std::string::npos);
+
+    // Unpinned, non-realtime roles only rename the thread, which always works.
+    REQUIRE(ThreadConfig{}.apply(ThreadRole::Ingest));
+}